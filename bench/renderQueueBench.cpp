@@ -0,0 +1,326 @@
+// Valor engine by Valores M.
+// Per-object glDrawArrays vs RenderQueue multi-draw indirect, prints JSON to stdout. Both
+// paths must draw the same image at every size, the bench fails on any pixel difference.
+// Needs a GL 4.3 driver reachable through EGL without a window (Mesa surfaceless works,
+// llvmpipe included). Build with bench/Makefile
+#include <glad/glad.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include "skMath.h"
+#include "renderQueue.h"
+
+#include <glm.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Settings
+static const size_t objectCounts[] = { 1000, 10000, 100000 };
+// fewer frames for the big scenes, a software rasterizer needs seconds per frame there
+static int framesFor(size_t objects) {
+	return objects >= 100000 ? 5 : objects >= 10000 ? 15 : 31;
+}
+static const int targetSize = 64;
+// End of Settings
+
+static const char* perObjectVS =
+	"#version 430 core\n"
+	"layout (location = 0) in vec3 aPos;\n"
+	"uniform mat4 viewProj;\n"
+	"uniform mat4 model;\n"
+	"void main() { gl_Position = viewProj * model * vec4(aPos, 1.0); }\n";
+// same transform, model from the DrawData record the way shaders/vertex.vs does it
+static const char* queueVS =
+	"#version 430 core\n"
+	"#extension GL_ARB_shader_draw_parameters : enable\n"
+	"layout (location = 0) in vec3 aPos;\n"
+	"layout (location = 2) in uint aDrawIndex;\n"
+	"uniform mat4 viewProj;\n"
+	"struct DrawData { mat4 model; uint material; };\n"
+	"layout (std430, binding = 0) readonly buffer DrawBuffer { DrawData draws[]; };\n"
+	"void main() {\n"
+	"#ifdef GL_ARB_shader_draw_parameters\n"
+	"    uint drawIndex = uint(gl_BaseInstanceARB + gl_InstanceID);\n"
+	"#else\n"
+	"    uint drawIndex = aDrawIndex;\n"
+	"#endif\n"
+	"    gl_Position = viewProj * draws[drawIndex].model * vec4(aPos, 1.0);\n"
+	"}\n";
+static const char* colorFS =
+	"#version 430 core\n"
+	"out vec4 FragColor;\n"
+	"void main() { FragColor = vec4(1.0, 0.5, 0.2, 1.0); }\n";
+
+static bool createContext() {
+	EGLDisplay display = EGL_NO_DISPLAY;
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	if (getPlatformDisplay != nullptr) {
+		display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+	}
+	if (display == EGL_NO_DISPLAY) {
+		display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	}
+	EGLint major, minor;
+	if (!eglInitialize(display, &major, &minor)) {
+		fprintf(stderr, "ERROR::BENCH::EGL_INIT_FAILED\n");
+		return false;
+	}
+	EGLint configAttribs[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+	EGLConfig config;
+	EGLint configCount = 0;
+	eglChooseConfig(display, configAttribs, &config, 1, &configCount);
+	eglBindAPI(EGL_OPENGL_API);
+	EGLint contextAttribs[] = { EGL_CONTEXT_MAJOR_VERSION, 4, EGL_CONTEXT_MINOR_VERSION, 3, EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT, EGL_NONE };
+	EGLContext context = eglCreateContext(display, configCount ? config : NULL, EGL_NO_CONTEXT, contextAttribs);
+	if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+		fprintf(stderr, "ERROR::BENCH::NO_GL_4_3_CONTEXT\n");
+		return false;
+	}
+	if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress)) {
+		fprintf(stderr, "ERROR::BENCH::GLAD_LOAD_FAILED\n");
+		return false;
+	}
+	GLExt::get().load((GLADloadproc)eglGetProcAddress);
+	return true;
+}
+
+static GLuint buildProgram(const char* vs, const char* fs) {
+	Shader shader;
+	shader.beginCompile(vs, fs);
+	return shader.finishCompile() ? shader.ID : 0;
+}
+
+// Three different meshes so the queue has real heterogeneous multi-draws: cube, pyramid, quad
+static void appendCube(std::vector<float>& v) {
+	static const float p[8][3] = { {-1,-1,-1}, {1,-1,-1}, {1,1,-1}, {-1,1,-1}, {-1,-1,1}, {1,-1,1}, {1,1,1}, {-1,1,1} };
+	static const int faces[6][4] = { {0,1,2,3}, {5,4,7,6}, {4,0,3,7}, {1,5,6,2}, {3,2,6,7}, {4,5,1,0} };
+	for (int f = 0; f < 6; f++) {
+		const int tri[6] = { 0, 1, 2, 0, 2, 3 };
+		for (int k = 0; k < 6; k++) {
+			const float* c = p[faces[f][tri[k]]];
+			v.insert(v.end(), { c[0] * 0.5f, c[1] * 0.5f, c[2] * 0.5f, 0.0f, 0.0f });
+		}
+	}
+}
+static void appendPyramid(std::vector<float>& v) {
+	static const float p[5][3] = { {-0.5f,0,-0.5f}, {0.5f,0,-0.5f}, {0.5f,0,0.5f}, {-0.5f,0,0.5f}, {0,0.8f,0} };
+	static const int tris[6][3] = { {0,1,4}, {1,2,4}, {2,3,4}, {3,0,4}, {0,2,1}, {0,3,2} };
+	for (int t = 0; t < 6; t++) {
+		for (int k = 0; k < 3; k++) {
+			const float* c = p[tris[t][k]];
+			v.insert(v.end(), { c[0], c[1], c[2], 0.0f, 0.0f });
+		}
+	}
+}
+static void appendQuad(std::vector<float>& v) {
+	static const float p[6][2] = { {-0.5f,-0.5f}, {0.5f,-0.5f}, {0.5f,0.5f}, {-0.5f,-0.5f}, {0.5f,0.5f}, {-0.5f,0.5f} };
+	for (int k = 0; k < 6; k++) {
+		v.insert(v.end(), { p[k][0], p[k][1], 0.0f, 0.0f, 0.0f });
+	}
+}
+
+struct Scene {
+	std::vector<float> vertices;
+	// first vertex and count of each mesh inside vertices
+	GLint first[3];
+	GLsizei count[3];
+	std::vector<Mat4x4<float>> models;
+	std::vector<int> meshOf;
+};
+
+static Scene buildScene(size_t objects) {
+	Scene scene;
+	void (*append[3])(std::vector<float>&) = { appendCube, appendPyramid, appendQuad };
+	for (int m = 0; m < 3; m++) {
+		scene.first[m] = (GLint)(scene.vertices.size() / MeshPool::floatsPerVertex);
+		append[m](scene.vertices);
+		scene.count[m] = (GLsizei)(scene.vertices.size() / MeshPool::floatsPerVertex) - scene.first[m];
+	}
+	// a square grid in front of the camera, small enough that vertex work dominates
+	size_t side = (size_t)std::ceil(std::sqrt((double)objects));
+	float spacing = 2.0f / (float)side;
+	for (size_t i = 0; i < objects; i++) {
+		float x = -1.0f + spacing * (float)(i % side);
+		float y = -1.0f + spacing * (float)(i / side);
+		scene.models.push_back(Mat4x4<float>::trs(Vect3<float>(x, y, 0.0f), Vect3<float>(0.3f, 1.0f, 0.2f), (float)i * 0.01f, Vect3<float>(spacing * 0.4f, spacing * 0.4f, spacing * 0.4f)));
+		scene.meshOf.push_back((int)(i % 3));
+	}
+	return scene;
+}
+
+struct BenchResult {
+	std::string path;
+	size_t objects;
+	size_t drawCalls;
+	// RGBA8 read back after the warm-up frame
+	std::vector<unsigned char> image;
+	// CPU time to record and submit a frame, and the same plus glFinish
+	std::vector<double> submitMs;
+	std::vector<double> frameMs;
+
+	static double percentile(std::vector<double> v, double p) {
+		std::sort(v.begin(), v.end());
+		return v[(size_t)(p * (double)(v.size() - 1) + 0.5)];
+	}
+};
+
+template<class Submit>
+static BenchResult runCase(const std::string& path, size_t objects, Submit submit) {
+	BenchResult result;
+	result.path = path;
+	result.objects = objects;
+	// warm up: shader variants, buffer allocation, first-use driver work. Its frame is the
+	// one compared against the other path
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	result.drawCalls = submit();
+	result.image.resize(targetSize * targetSize * 4);
+	glReadPixels(0, 0, targetSize, targetSize, GL_RGBA, GL_UNSIGNED_BYTE, result.image.data());
+	int frames = framesFor(objects);
+	for (int f = 0; f < frames; f++) {
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		glFinish();
+		std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+		submit();
+		std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+		glFinish();
+		std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+		result.submitMs.push_back(std::chrono::duration<double, std::milli>(t1 - t0).count());
+		result.frameMs.push_back(std::chrono::duration<double, std::milli>(t2 - t0).count());
+	}
+	return result;
+}
+
+// Pixels where two frames differ, first is the index of the first one
+static size_t countDifferences(const BenchResult& a, const BenchResult& b, size_t& first) {
+	size_t differences = 0;
+	for (size_t i = 0; i < a.image.size(); i += 4) {
+		if (memcmp(&a.image[i], &b.image[i], 4) != 0) {
+			if (differences == 0) {
+				first = i / 4;
+			}
+			differences++;
+		}
+	}
+	return differences;
+}
+
+int main() {
+	if (!createContext()) {
+		return 1;
+	}
+	ProgramBinaryCache::get().enabled = false;
+	GLuint perObjectProgram = buildProgram(perObjectVS, colorFS);
+	GLuint queueProgram = buildProgram(queueVS, colorFS);
+	if (perObjectProgram == 0 || queueProgram == 0) {
+		return 1;
+	}
+	GLState& state = GLState::get();
+
+	GLuint target, depth, framebuffer;
+	glGenRenderbuffers(1, &target);
+	glBindRenderbuffer(GL_RENDERBUFFER, target);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, targetSize, targetSize);
+	glGenRenderbuffers(1, &depth);
+	glBindRenderbuffer(GL_RENDERBUFFER, depth);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, targetSize, targetSize);
+	glGenFramebuffers(1, &framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, target);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+	glViewport(0, 0, targetSize, targetSize);
+	state.setDepthTest(true);
+
+	glm::mat4 viewProj(1.0f);
+	viewProj[2][2] = 0.1f;
+	state.useProgram(perObjectProgram);
+	glUniformMatrix4fv(glGetUniformLocation(perObjectProgram, "viewProj"), 1, GL_FALSE, &viewProj[0][0]);
+	GLint modelLocation = glGetUniformLocation(perObjectProgram, "model");
+	state.useProgram(queueProgram);
+	glUniformMatrix4fv(glGetUniformLocation(queueProgram, "viewProj"), 1, GL_FALSE, &viewProj[0][0]);
+
+	std::vector<BenchResult> results;
+	bool imagesMatch = true;
+	for (size_t objects : objectCounts) {
+		Scene scene = buildScene(objects);
+
+		// the way valor.cpp drew before the queue: one VAO, a uniform and a draw per object
+		GLuint arraysVAO, arraysVBO;
+		glGenVertexArrays(1, &arraysVAO);
+		glGenBuffers(1, &arraysVBO);
+		state.bindVertexArray(arraysVAO);
+		state.bindBuffer(GL_ARRAY_BUFFER, arraysVBO);
+		glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(scene.vertices.size() * sizeof(float)), scene.vertices.data(), GL_STATIC_DRAW);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, MeshPool::floatsPerVertex * sizeof(float), (void*)0);
+		glEnableVertexAttribArray(0);
+		results.push_back(runCase("draw_arrays", objects, [&]() -> size_t {
+			state.useProgram(perObjectProgram);
+			state.bindVertexArray(arraysVAO);
+			for (size_t i = 0; i < objects; i++) {
+				int m = scene.meshOf[i];
+				glUniformMatrix4fv(modelLocation, 1, GL_FALSE, scene.models[i].data());
+				glDrawArrays(GL_TRIANGLES, scene.first[m], scene.count[m]);
+			}
+			return objects;
+		}));
+
+		DrawDataBuffer drawData;
+		drawData.create(objects);
+		MeshPool meshes;
+		for (int m = 0; m < 3; m++) {
+			meshes.addArrays(&scene.vertices[scene.first[m] * MeshPool::floatsPerVertex], (size_t)scene.count[m]);
+		}
+		meshes.upload(&drawData);
+		RenderQueue queue;
+		results.push_back(runCase("multi_draw_indirect", objects, [&]() -> size_t {
+			for (size_t i = 0; i < objects; i++) {
+				DrawPacket packet;
+				packet.program = queueProgram;
+				packet.mesh = scene.meshOf[i];
+				packet.model = scene.models[i].data();
+				queue.submit(packet);
+			}
+			queue.flush(meshes, drawData, nullptr);
+			return queue.frame().multiDraws;
+		}));
+		size_t first = 0;
+		size_t differences = countDifferences(results[results.size() - 2], results.back(), first);
+		if (differences != 0) {
+			fprintf(stderr, "ERROR::BENCH::IMAGE_MISMATCH\n%zu objects: %zu of %d pixels differ, first at (%zu, %zu)\n",
+				objects, differences, targetSize * targetSize, first % targetSize, first / targetSize);
+			imagesMatch = false;
+		}
+
+		queue.destroy();
+		meshes.destroy();
+		drawData.destroy();
+		state.forgetVertexArray(arraysVAO);
+		state.forgetBuffer(arraysVBO);
+		glDeleteVertexArrays(1, &arraysVAO);
+		glDeleteBuffers(1, &arraysVBO);
+	}
+
+	printf("{\n");
+	printf("  \"renderer\": \"%s\",\n", (const char*)glGetString(GL_RENDERER));
+	printf("  \"draw_parameters\": %s,\n", GLExt::get().drawParameters ? "true" : "false");
+	printf("  \"results\": [\n");
+	for (size_t i = 0; i < results.size(); i++) {
+		const BenchResult& r = results[i];
+		printf("    { \"path\": \"%s\", \"objects\": %zu, \"draw_calls\": %zu, \"frames\": %zu, "
+			"\"submit_ms\": { \"min\": %.3f, \"p50\": %.3f, \"max\": %.3f }, "
+			"\"frame_ms\": { \"min\": %.3f, \"p50\": %.3f, \"max\": %.3f } }%s\n",
+			r.path.c_str(), r.objects, r.drawCalls, r.submitMs.size(),
+			BenchResult::percentile(r.submitMs, 0.0), BenchResult::percentile(r.submitMs, 0.5), BenchResult::percentile(r.submitMs, 1.0),
+			BenchResult::percentile(r.frameMs, 0.0), BenchResult::percentile(r.frameMs, 0.5), BenchResult::percentile(r.frameMs, 1.0),
+			i + 1 < results.size() ? "," : "");
+	}
+	printf("  ],\n");
+	printf("  \"images_match\": %s\n}\n", imagesMatch ? "true" : "false");
+	return imagesMatch ? 0 : 1;
+}
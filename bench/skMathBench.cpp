@@ -0,0 +1,268 @@
+// Valor engine by Valores M.
+// skMath vs vendored glm micro benchmarks, prints JSON to stdout. Build with bench/Makefile
+#include <glad/glad.h>
+#include "skMath.h"
+
+#include <glm.hpp>
+#include <gtc/matrix_transform.hpp>
+#include <gtc/matrix_inverse.hpp>
+#include <gtc/quaternion.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Settings
+static int sampleCount = 31;
+static const size_t batchSizes[] = { 16, 1024, 65536 };
+// Every sample runs the kernel over at least this many elements so short batches still time well
+static const size_t minElementsPerSample = 65536;
+// End of Settings
+
+// Keeps results observable so the optimizer can't drop the work
+static volatile float sink = 0.0f;
+
+static const char* tierName(skSimdLevel level) {
+	switch (level) {
+	case SK_SIMD_AVX2: return "avx2";
+	case SK_SIMD_SSE41: return "sse41";
+	default: return "scalar";
+	}
+}
+
+static float rnd() {
+	return (float)rand() / (float)RAND_MAX * 2.0f - 1.0f;
+}
+
+struct BenchData {
+	size_t count;
+	std::vector<Mat4x4<float>> matA, matB, matOut;
+	std::vector<Vect4<float>> vecIn, vecOut;
+	std::vector<float> posX, posY, posZ, axisX, axisY, axisZ, angle, scaleX, scaleY, scaleZ, matFloats;
+	std::vector<float> qa[4], qb[4], qOut[4], t;
+	std::vector<float> nx, ny, nz;
+	std::vector<glm::mat4> gA, gB, gOut;
+	std::vector<glm::vec4> gVecIn, gVecOut;
+	std::vector<glm::quat> gqa, gqb, gqOut;
+	std::vector<glm::vec3> gNorm;
+
+	explicit BenchData(size_t n) : count(n) {
+		matA.resize(n); matB.resize(n); matOut.resize(n);
+		vecIn.resize(n); vecOut.resize(n);
+		posX.resize(n); posY.resize(n); posZ.resize(n);
+		axisX.resize(n); axisY.resize(n); axisZ.resize(n); angle.resize(n);
+		scaleX.resize(n); scaleY.resize(n); scaleZ.resize(n);
+		matFloats.resize(n * 16);
+		for (int c = 0; c < 4; c++) {
+			qa[c].resize(n); qb[c].resize(n); qOut[c].resize(n);
+		}
+		t.resize(n);
+		nx.resize(n); ny.resize(n); nz.resize(n);
+		gA.resize(n); gB.resize(n); gOut.resize(n);
+		gVecIn.resize(n); gVecOut.resize(n);
+		gqa.resize(n); gqb.resize(n); gqOut.resize(n);
+		gNorm.resize(n);
+		for (size_t i = 0; i < n; i++) {
+			posX[i] = rnd() * 10.0f; posY[i] = rnd() * 10.0f; posZ[i] = rnd() * 10.0f;
+			axisX[i] = rnd(); axisY[i] = rnd(); axisZ[i] = rnd() + 1.5f; angle[i] = rnd() * 3.0f;
+			scaleX[i] = rnd() + 2.0f; scaleY[i] = rnd() + 2.0f; scaleZ[i] = rnd() + 2.0f;
+			matA[i] = Mat4x4<float>::trs(Vect3<float>(posX[i], posY[i], posZ[i]), Vect3<float>(axisX[i], axisY[i], axisZ[i]), angle[i], Vect3<float>(scaleX[i], scaleY[i], scaleZ[i]));
+			matB[i] = Mat4x4<float>::trs(Vect3<float>(posY[i], posZ[i], posX[i]), Vect3<float>(axisZ[i], axisX[i], axisY[i]), -angle[i], Vect3<float>(1.0f, 1.0f, 1.0f));
+			memcpy(&gA[i][0][0], matA[i].data(), sizeof(glm::mat4));
+			memcpy(&gB[i][0][0], matB[i].data(), sizeof(glm::mat4));
+			vecIn[i] = Vect4<float>(rnd(), rnd(), rnd(), 1.0f);
+			gVecIn[i] = glm::vec4(vecIn[i].x, vecIn[i].y, vecIn[i].z, vecIn[i].w);
+			Quaternion<float> a = Quaternion<float>::normalize(Quaternion<float>(rnd(), rnd(), rnd(), rnd()));
+			Quaternion<float> b = Quaternion<float>::normalize(Quaternion<float>(rnd(), rnd(), rnd(), rnd()));
+			qa[0][i] = a.q.x; qa[1][i] = a.q.y; qa[2][i] = a.q.z; qa[3][i] = a.q.w;
+			qb[0][i] = b.q.x; qb[1][i] = b.q.y; qb[2][i] = b.q.z; qb[3][i] = b.q.w;
+			gqa[i] = glm::quat(a.q.w, a.q.x, a.q.y, a.q.z);
+			gqb[i] = glm::quat(b.q.w, b.q.x, b.q.y, b.q.z);
+			t[i] = (rnd() + 1.0f) * 0.5f;
+			nx[i] = rnd() * 5.0f; ny[i] = rnd() * 5.0f; nz[i] = rnd() * 5.0f;
+			gNorm[i] = glm::vec3(nx[i], ny[i], nz[i]);
+		}
+	}
+	skTransformSoA transforms() const {
+		skTransformSoA soa;
+		soa.posX = posX.data(); soa.posY = posY.data(); soa.posZ = posZ.data();
+		soa.axisX = axisX.data(); soa.axisY = axisY.data(); soa.axisZ = axisZ.data();
+		soa.angle = angle.data();
+		soa.scaleX = scaleX.data(); soa.scaleY = scaleY.data(); soa.scaleZ = scaleZ.data();
+		return soa;
+	}
+	static skQuatSoA quats(std::vector<float> q[4]) {
+		skQuatSoA soa;
+		soa.x = q[0].data(); soa.y = q[1].data(); soa.z = q[2].data(); soa.w = q[3].data();
+		return soa;
+	}
+};
+
+struct BenchResult {
+	std::string name;
+	std::string lib;
+	std::string tier;
+	size_t batch;
+	std::vector<double> nsPerOp;
+
+	double percentile(double p) const {
+		std::vector<double> sorted(nsPerOp);
+		std::sort(sorted.begin(), sorted.end());
+		size_t idx = (size_t)(p * (double)(sorted.size() - 1) + 0.5);
+		return sorted[idx];
+	}
+};
+
+static BenchResult runCase(const std::string& name, const std::string& lib, const std::string& tier, size_t batch, const std::function<void()>& fn) {
+	BenchResult result;
+	result.name = name;
+	result.lib = lib;
+	result.tier = tier;
+	result.batch = batch;
+	size_t reps = batch >= minElementsPerSample ? 1 : minElementsPerSample / batch;
+	// warm caches and page in the outputs
+	fn();
+	for (int s = 0; s < sampleCount; s++) {
+		std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+		for (size_t r = 0; r < reps; r++) {
+			fn();
+		}
+		std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+		double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+		result.nsPerOp.push_back(ns / (double)(reps * batch));
+	}
+	return result;
+}
+
+static void printJson(const std::vector<BenchResult>& results) {
+	const skCpuFeatures& cpu = skKernels::cpu();
+	printf("{\n");
+	printf("  \"cpu\": { \"sse41\": %s, \"avx2\": %s, \"fma\": %s },\n", cpu.sse41 ? "true" : "false", cpu.avx2 ? "true" : "false", cpu.fma ? "true" : "false");
+	printf("  \"samples\": %d,\n", sampleCount);
+	printf("  \"results\": [\n");
+	for (size_t i = 0; i < results.size(); i++) {
+		const BenchResult& r = results[i];
+		double median = r.percentile(0.5);
+		printf("    { \"case\": \"%s\", \"lib\": \"%s\", \"tier\": \"%s\", \"batch\": %zu, "
+			"\"ns_per_op\": %.3f, \"ops_per_s\": %.0f, "
+			"\"spread\": { \"min\": %.3f, \"p10\": %.3f, \"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"max\": %.3f } }%s\n",
+			r.name.c_str(), r.lib.c_str(), r.tier.c_str(), r.batch,
+			median, median > 0.0 ? 1e9 / median : 0.0,
+			r.percentile(0.0), r.percentile(0.1), median, r.percentile(0.9), r.percentile(0.99), r.percentile(1.0),
+			i + 1 < results.size() ? "," : "");
+	}
+	printf("  ]\n}\n");
+}
+
+int main(int argc, char** argv) {
+	if (argc > 1) {
+		sampleCount = std::max(1, atoi(argv[1]));
+	}
+	srand(1234);
+	std::vector<BenchResult> results;
+	skSimdLevel best = skKernels::cpu().bestLevel();
+
+	for (size_t batch : batchSizes) {
+		BenchData d(batch);
+		const size_t n = batch;
+
+		// glm reference, plain loops the way engine code calls it
+		results.push_back(runCase("mat4_mul", "glm", "glm", n, [&]() {
+			for (size_t i = 0; i < n; i++) d.gOut[i] = d.gA[i] * d.gB[i];
+			sink = sink + d.gOut[n - 1][3][0];
+		}));
+		results.push_back(runCase("mat4_vec", "glm", "glm", n, [&]() {
+			for (size_t i = 0; i < n; i++) d.gVecOut[i] = d.gA[0] * d.gVecIn[i];
+			sink = sink + d.gVecOut[n - 1].x;
+		}));
+		results.push_back(runCase("compose_trs", "glm", "glm", n, [&]() {
+			for (size_t i = 0; i < n; i++) {
+				glm::mat4 m = glm::translate(glm::mat4(1.0f), glm::vec3(d.posX[i], d.posY[i], d.posZ[i]));
+				m = glm::rotate(m, d.angle[i], glm::vec3(d.axisX[i], d.axisY[i], d.axisZ[i]));
+				d.gOut[i] = glm::scale(m, glm::vec3(d.scaleX[i], d.scaleY[i], d.scaleZ[i]));
+			}
+			sink = sink + d.gOut[n - 1][3][0];
+		}));
+		results.push_back(runCase("quat_mult", "glm", "glm", n, [&]() {
+			for (size_t i = 0; i < n; i++) d.gqOut[i] = d.gqa[i] * d.gqb[i];
+			sink = sink + d.gqOut[n - 1].w;
+		}));
+		results.push_back(runCase("quat_slerp", "glm", "glm", n, [&]() {
+			for (size_t i = 0; i < n; i++) d.gqOut[i] = glm::slerp(d.gqa[i], d.gqb[i], d.t[i]);
+			sink = sink + d.gqOut[n - 1].w;
+		}));
+		results.push_back(runCase("quat_to_mat", "glm", "glm", n, [&]() {
+			for (size_t i = 0; i < n; i++) d.gOut[i] = glm::mat4_cast(d.gqa[i]);
+			sink = sink + d.gOut[n - 1][0][0];
+		}));
+		results.push_back(runCase("normalize3", "glm", "glm", n, [&]() {
+			for (size_t i = 0; i < n; i++) d.gNorm[i] = glm::normalize(d.gNorm[i]);
+			sink = sink + d.gNorm[n - 1].x;
+		}));
+		results.push_back(runCase("mat4_inverse", "glm", "glm", n, [&]() {
+			for (size_t i = 0; i < n; i++) d.gOut[i] = glm::inverse(d.gA[i]);
+			sink = sink + d.gOut[n - 1][0][0];
+		}));
+		results.push_back(runCase("affine_inverse", "glm", "glm", n, [&]() {
+			for (size_t i = 0; i < n; i++) d.gOut[i] = glm::affineInverse(d.gA[i]);
+			sink = sink + d.gOut[n - 1][0][0];
+		}));
+
+		// skMath at every tier this CPU can run, so a regression in one kernel shows up on its own
+		for (int level = SK_SIMD_SCALAR; level <= (int)best; level++) {
+			skKernels::setLevel((skSimdLevel)level);
+			std::string tier = tierName((skSimdLevel)level);
+			skTransformSoA soa = d.transforms();
+			skQuatSoA qa = BenchData::quats(d.qa), qb = BenchData::quats(d.qb), qOut = BenchData::quats(d.qOut);
+
+			results.push_back(runCase("mat4_mul", "skMath", tier, n, [&]() {
+				Mat4x4<float>::multMat4Batch(d.matA.data(), d.matB.data(), d.matOut.data(), n);
+				sink = sink + d.matOut[n - 1].row4.x;
+			}));
+			results.push_back(runCase("mat4_vec", "skMath", tier, n, [&]() {
+				Mat4x4<float>::multVect4Batch(d.matA[0], d.vecIn.data(), d.vecOut.data(), n);
+				sink = sink + d.vecOut[n - 1].x;
+			}));
+			results.push_back(runCase("compose_trs", "skMath", tier, n, [&]() {
+				TransformBatch::composeAxisAngle(soa, d.matFloats.data(), n);
+				sink = sink + d.matFloats[n * 16 - 4];
+			}));
+			results.push_back(runCase("quat_mult", "skMath", tier, n, [&]() {
+				QuaternionBatch::mult(qa, qb, qOut, n);
+				sink = sink + qOut.w[n - 1];
+			}));
+			results.push_back(runCase("quat_slerp", "skMath", tier, n, [&]() {
+				QuaternionBatch::slerp(qa, qb, d.t.data(), qOut, n);
+				sink = sink + qOut.w[n - 1];
+			}));
+			results.push_back(runCase("quat_to_mat", "skMath", tier, n, [&]() {
+				QuaternionBatch::toMat4(qa, d.matFloats.data(), n);
+				sink = sink + d.matFloats[0];
+			}));
+			results.push_back(runCase("normalize3", "skMath", tier, n, [&]() {
+				skMathFn<SK_PRECISE>::normalizeBatch(d.nx.data(), d.ny.data(), d.nz.data(), n);
+				sink = sink + d.nx[n - 1];
+			}));
+			results.push_back(runCase("normalize3_fast", "skMath", tier, n, [&]() {
+				skMathFn<SK_FAST>::normalizeBatch(d.nx.data(), d.ny.data(), d.nz.data(), n);
+				sink = sink + d.nx[n - 1];
+			}));
+			results.push_back(runCase("mat4_inverse", "skMath", tier, n, [&]() {
+				Mat4x4<float>::inverseBatch(d.matA.data(), d.matOut.data(), n);
+				sink = sink + d.matOut[n - 1].row1.x;
+			}));
+			results.push_back(runCase("affine_inverse", "skMath", tier, n, [&]() {
+				Mat4x4<float>::affineInverseBatch(d.matA.data(), d.matOut.data(), n);
+				sink = sink + d.matOut[n - 1].row1.x;
+			}));
+		}
+		skKernels::setLevel(best);
+	}
+	printJson(results);
+	return 0;
+}
@@ -0,0 +1,225 @@
+// Valor engine by Valores M.
+// Per-draw data in a shader storage buffer, read by index in the vertex shader
+#ifndef DRAWDATA_H
+#define DRAWDATA_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "glExt.h"
+#include "glState.h"
+#include "frameRing.h"
+
+// SSBO binding points are their own namespace, separate from UniformBinding
+enum StorageBinding {
+	SK_SSBO_DRAW = 0
+};
+// Vertex attribute carrying the draw index when gl_BaseInstanceARB is not available
+const GLuint SK_ATTRIB_DRAW_INDEX = 2;
+
+// Mirror of the GLSL struct in shaders/common.glsl, std430 rounds the struct up to 16 bytes
+//   struct DrawData { mat4 model; uint material; };
+struct alignas(16) DrawData {
+	float model[16];
+	uint32_t material;
+	uint32_t pad[3];
+};
+static_assert(sizeof(DrawData) == 80, "DrawData must match the std430 array stride");
+static_assert(offsetof(DrawData, material) == 64, "material follows the mat4");
+
+// Every draw of a frame gets one DrawData record, its index reaches the shader as the base
+// instance: glDrawArraysInstancedBaseInstance(mode, first, count, 1, index). The shader reads
+// gl_BaseInstanceARB + gl_InstanceID with GL_ARB_shader_draw_parameters, otherwise the
+// same value comes from an instanced attribute holding 0, 1, 2... (divisor 1 adds the base
+// instance too). Draws then need no uniform calls between them and can be merged into
+// instanced or multi-draw calls later
+class DrawDataBuffer {
+public:
+	GLuint buffer = 0;
+	// 0..capacity-1 for the attribute fallback
+	GLuint indexBuffer = 0;
+
+	void create(size_t initialCapacity) {
+		glGenBuffers(1, &buffer);
+		glGenBuffers(1, &indexBuffer);
+		reserve(initialCapacity > 0 ? initialCapacity : 1);
+	}
+	// Adds the draw index attribute to a VAO. Harmless when the shader never reads it
+	void attach(GLuint vertexArray) {
+		GLState& state = GLState::get();
+		state.bindVertexArray(vertexArray);
+		state.bindBuffer(GL_ARRAY_BUFFER, indexBuffer);
+		glVertexAttribIPointer(SK_ATTRIB_DRAW_INDEX, 1, GL_UNSIGNED_INT, sizeof(GLuint), (void*)0);
+		glVertexAttribDivisor(SK_ATTRIB_DRAW_INDEX, 1);
+		glEnableVertexAttribArray(SK_ATTRIB_DRAW_INDEX);
+	}
+	void reset() {
+		records.clear();
+	}
+	// Index to pass as baseInstance
+	GLuint push(const float* model, uint32_t material) {
+		DrawData d;
+		memcpy(d.model, model, sizeof(d.model));
+		d.material = material;
+		d.pad[0] = d.pad[1] = d.pad[2] = 0;
+		records.push_back(d);
+		return (GLuint)(records.size() - 1);
+	}
+	// One transfer for the whole frame. The old storage is orphaned so the driver does not
+	// stall on draws still reading last frame's records
+	void upload() {
+		if (records.size() > capacity) {
+			reserve(records.size() * 2);
+		}
+		GLState& state = GLState::get();
+		state.bindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr)(capacity * sizeof(DrawData)), NULL, GL_STREAM_DRAW);
+		if (!records.empty()) {
+			glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, (GLsizeiptr)(records.size() * sizeof(DrawData)), records.data());
+		}
+		state.bindBufferBase(GL_SHADER_STORAGE_BUFFER, SK_SSBO_DRAW, buffer);
+	}
+	// Same through the frame ring, the records land in this frame's region
+	void upload(FrameRing& ring) {
+		if (records.empty()) {
+			return;
+		}
+		RingAllocation slice = ring.write(records.data(), records.size() * sizeof(DrawData), FrameRing::storageAlignment());
+		if (!slice.valid()) {
+			upload();
+			return;
+		}
+		GLState::get().bindBufferRange(GL_SHADER_STORAGE_BUFFER, SK_SSBO_DRAW, ring.buffer, slice.offset, slice.size);
+	}
+	void destroy() {
+		GLState& state = GLState::get();
+		state.forgetBuffer(buffer);
+		state.forgetBuffer(indexBuffer);
+		glDeleteBuffers(1, &buffer);
+		glDeleteBuffers(1, &indexBuffer);
+		buffer = 0;
+		indexBuffer = 0;
+		capacity = 0;
+	}
+	size_t size() const {
+		return records.size();
+	}
+	const DrawData& operator[](size_t i) const {
+		return records[i];
+	}
+	static void report() {
+		std::cout << "DRAWDATA::INDEX " << (GLExt::get().drawParameters ? "gl_BaseInstanceARB" : "instanced attribute") << std::endl;
+	}
+private:
+	std::vector<DrawData> records;
+	size_t capacity = 0;
+
+	// Grows both buffers, the index attribute must cover every record. VAOs point at the
+	// buffer object, not its storage, so attached VAOs need no update
+	void reserve(size_t count) {
+		capacity = count;
+		std::vector<GLuint> indices(capacity);
+		for (size_t i = 0; i < capacity; i++) {
+			indices[i] = (GLuint)i;
+		}
+		GLState& state = GLState::get();
+		state.bindBuffer(GL_ARRAY_BUFFER, indexBuffer);
+		glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(capacity * sizeof(GLuint)), indices.data(), GL_STATIC_DRAW);
+		state.bindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr)(capacity * sizeof(DrawData)), NULL, GL_STREAM_DRAW);
+	}
+};
+
+// Draws waiting for a flush. Draw is any draw description with a model pointer and a
+// material index: the 16 column-major floats are copied on push, so callers
+// may pass temporaries, and the stored description's pointer is cleared
+template<class Draw>
+class DrawQueue {
+public:
+	struct Entry {
+		Draw draw;
+		float model[16];
+	};
+
+	uint32_t push(const Draw& draw) {
+		Entry e;
+		e.draw = draw;
+		std::copy(draw.model, draw.model + 16, e.model);
+		e.draw.model = nullptr;
+		entries.push_back(e);
+		return (uint32_t)(entries.size() - 1);
+	}
+	const Entry& operator[](size_t i) const {
+		return entries[i];
+	}
+	size_t size() const {
+		return entries.size();
+	}
+	bool empty() const {
+		return entries.empty();
+	}
+	void clear() {
+		entries.clear();
+	}
+private:
+	std::vector<Entry> entries;
+};
+
+// Neighbouring draws that share everything but their DrawData record, one instanced call
+struct DrawRun {
+	// queue index of the first draw, its description stands for the whole run
+	uint32_t draw;
+	GLuint baseInstance;
+	GLsizei instances;
+};
+
+// Walks queue in order, gives every draw a DrawData record (drawData is reset first) and
+// starts a new run whenever same(previous, current) is false, so the records of a run are
+// consecutive. Uploads the records, through ring when given
+template<class Draw, class Same>
+void buildDrawRuns(const DrawQueue<Draw>& queue, const std::vector<uint32_t>& order, DrawDataBuffer& drawData, FrameRing* ring, std::vector<DrawRun>& runs, Same same) {
+	runs.clear();
+	drawData.reset();
+	for (size_t i = 0; i < order.size(); i++) {
+		const typename DrawQueue<Draw>::Entry& e = queue[order[i]];
+		GLuint record = drawData.push(e.model, (uint32_t)e.draw.material);
+		if (runs.empty() || !same(queue[runs.back().draw].draw, e.draw)) {
+			DrawRun r;
+			r.draw = order[i];
+			r.baseInstance = record;
+			r.instances = 0;
+			runs.push_back(r);
+		}
+		runs.back().instances++;
+	}
+	if (ring != nullptr) {
+		drawData.upload(*ring);
+	}
+	else {
+		drawData.upload();
+	}
+}
+
+inline GLint indexTypeSize(GLenum type) {
+	return type == GL_UNSIGNED_BYTE ? 1 : type == GL_UNSIGNED_SHORT ? 2 : 4;
+}
+
+// One run as glDrawArraysInstancedBaseInstance, or the Elements variant when indexType is
+// set (first then counts indices into the bound element buffer)
+inline void drawRunInstanced(GLenum mode, GLint first, GLsizei count, GLenum indexType, const DrawRun& run) {
+	if (indexType == 0) {
+		glDrawArraysInstancedBaseInstance(mode, first, count, run.instances, run.baseInstance);
+	}
+	else {
+		const void* offset = (const void*)(size_t)(first * indexTypeSize(indexType));
+		glDrawElementsInstancedBaseInstance(mode, count, indexType, offset, run.instances, run.baseInstance);
+	}
+}
+
+#endif // !DRAWDATA_H
@@ -0,0 +1,234 @@
+// Valor engine by Valores M.
+// Triple-buffered, persistently mapped ring for everything written once per frame
+#ifndef FRAMERING_H
+#define FRAMERING_H
+
+#include <glad/glad.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+#include "glExt.h"
+#include "glState.h"
+
+// Where one allocation landed: bind buffer at offset. data is the mapped address on the
+// persistent path and nullptr otherwise
+struct RingAllocation {
+	void* data = nullptr;
+	GLintptr offset = 0;
+	GLsizeiptr size = 0;
+
+	bool valid() const {
+		return size > 0;
+	}
+};
+
+struct FrameRingStats {
+	size_t frames = 0;
+	// frames whose region was still being read by the GPU when we came back to it
+	size_t stalls = 0;
+	double stallMs = 0.0;
+	size_t peakBytes = 0;
+	size_t failedAllocations = 0;
+};
+
+// One buffer split into frameCount regions. beginFrame() moves to the next region and waits
+// on the fence placed when that region was last used, endFrame() places a new fence.
+// Between them write() and allocate() hand out aligned slices of the region: the CPU writes
+// straight into GPU visible memory, no glBufferData/glBufferSubData copy and no implicit
+// sync. The buffer is mapped once with GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT when
+// glBufferStorage exists (GL 4.4 / ARB_buffer_storage). Plain 4.3 cannot draw from a
+// mapped buffer, so write() maps just the slice unsynchronized and unmaps it again, the
+// fences keep that just as safe
+class FrameRing {
+public:
+	static const int frameCount = 3;
+
+	GLuint buffer = 0;
+
+	// False when no buffer could be allocated, the ring then hands out invalid slices and
+	// every caller uses its own buffer
+	bool create(size_t bytesPerFrame) {
+		regionSize = bytesPerFrame;
+		glGenBuffers(1, &buffer);
+		GLState& state = GLState::get();
+		// the copy target, so creating the ring never disturbs a real binding
+		state.bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+		GLsizeiptr total = (GLsizeiptr)(regionSize * frameCount);
+		persistent = GLExt::get().bufferStorage != nullptr;
+		if (persistent) {
+			GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			GLExt::get().bufferStorage(GL_COPY_WRITE_BUFFER, total, NULL, flags);
+			mapped = (unsigned char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, total, flags);
+			if (mapped == nullptr) {
+				std::cout << "ERROR::FRAMERING::PERSISTENT_MAP_FAILED\nfalling back to unsynchronized slice maps" << std::endl;
+				// immutable storage can't be respecified, start over with a plain buffer
+				state.forgetBuffer(buffer);
+				glDeleteBuffers(1, &buffer);
+				glGenBuffers(1, &buffer);
+				state.bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+				persistent = false;
+			}
+		}
+		if (!persistent) {
+			glBufferData(GL_COPY_WRITE_BUFFER, total, NULL, GL_STREAM_DRAW);
+			GLint size = 0;
+			glGetBufferParameteriv(GL_COPY_WRITE_BUFFER, GL_BUFFER_SIZE, &size);
+			if ((GLsizeiptr)size != total) {
+				std::cout << "ERROR::FRAMERING::ALLOCATION_FAILED\n" << total << " bytes" << std::endl;
+				state.forgetBuffer(buffer);
+				glDeleteBuffers(1, &buffer);
+				buffer = 0;
+				return false;
+			}
+		}
+		for (int i = 0; i < frameCount; i++) {
+			fences[i] = 0;
+		}
+		region = frameCount - 1;
+		return true;
+	}
+	void beginFrame() {
+		if (buffer == 0) {
+			return;
+		}
+		region = (region + 1) % frameCount;
+		waitRegion(region);
+		head = 0;
+		stats.frames++;
+		inFrame = true;
+	}
+	// Copies bytes into the ring, invalid when the region is full (raise bytesPerFrame then)
+	// or the slice could not be mapped
+	RingAllocation write(const void* source, size_t bytes, size_t alignment) {
+		RingAllocation a = reserve(bytes, alignment);
+		if (!a.valid()) {
+			return a;
+		}
+		if (persistent) {
+			memcpy(a.data, source, bytes);
+			return a;
+		}
+		GLState::get().bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+		// the fence already covers the GPU side, unsynchronized skips the driver's own wait
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+		void* slice = glMapBufferRange(GL_COPY_WRITE_BUFFER, a.offset, a.size, flags);
+		if (slice == nullptr) {
+			if (stats.failedAllocations++ == 0) {
+				std::cout << "ERROR::FRAMERING::SLICE_MAP_FAILED\n" << bytes << " bytes at " << a.offset << std::endl;
+			}
+			return RingAllocation();
+		}
+		memcpy(slice, source, bytes);
+		glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+		return a;
+	}
+	// Slice to fill in place (e.g. debug geometry built straight into the ring). Persistent
+	// path only, check isPersistent() and use write() otherwise
+	RingAllocation allocate(size_t bytes, size_t alignment) {
+		if (!persistent) {
+			return RingAllocation();
+		}
+		return reserve(bytes, alignment);
+	}
+	// After the frame's last draw that reads the ring
+	void endFrame() {
+		if (!inFrame) {
+			return;
+		}
+		fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		inFrame = false;
+	}
+	static size_t uniformAlignment() {
+		static GLint alignment = 0;
+		if (alignment <= 0) {
+			glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+		}
+		return alignment > 0 ? (size_t)alignment : 256;
+	}
+	static size_t storageAlignment() {
+		static GLint alignment = 0;
+		if (alignment <= 0) {
+			glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+		}
+		return alignment > 0 ? (size_t)alignment : 256;
+	}
+	bool isPersistent() const {
+		return persistent;
+	}
+	const FrameRingStats& statistics() const {
+		return stats;
+	}
+	void report() const {
+		std::cout << "FRAMERING::" << (persistent ? "PERSISTENT" : "UNSYNCHRONIZED_MAP") << " frames " << stats.frames << " stalls " << stats.stalls
+			<< " (" << stats.stallMs << " ms) peak " << stats.peakBytes << " of " << regionSize << " bytes per frame" << std::endl;
+	}
+	void destroy() {
+		for (int i = 0; i < frameCount; i++) {
+			if (fences[i] != 0) {
+				glDeleteSync(fences[i]);
+				fences[i] = 0;
+			}
+		}
+		if (mapped != nullptr) {
+			GLState::get().bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+			glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+			mapped = nullptr;
+		}
+		GLState::get().forgetBuffer(buffer);
+		glDeleteBuffers(1, &buffer);
+		buffer = 0;
+	}
+private:
+	size_t regionSize = 0;
+	size_t head = 0;
+	int region = 0;
+	bool persistent = false;
+	bool inFrame = false;
+	unsigned char* mapped = nullptr;
+	GLsync fences[frameCount] = {};
+	FrameRingStats stats;
+
+	RingAllocation reserve(size_t bytes, size_t alignment) {
+		RingAllocation a;
+		if (!inFrame || bytes == 0) {
+			return a;
+		}
+		size_t start = (head + alignment - 1) / alignment * alignment;
+		if (start + bytes > regionSize) {
+			if (stats.failedAllocations++ == 0) {
+				std::cout << "ERROR::FRAMERING::OUT_OF_SPACE\n" << bytes << " bytes requested, " << regionSize - head << " left of " << regionSize << std::endl;
+			}
+			return a;
+		}
+		head = start + bytes;
+		a.offset = (GLintptr)(region * regionSize + start);
+		if (head > stats.peakBytes) {
+			stats.peakBytes = head;
+		}
+		a.data = persistent ? mapped + a.offset : nullptr;
+		a.size = (GLsizeiptr)bytes;
+		return a;
+	}
+	// Normally already signalled: the GPU finished that frame two frames ago
+	void waitRegion(int r) {
+		if (fences[r] == 0) {
+			return;
+		}
+		GLenum status = glClientWaitSync(fences[r], GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+		if (status == GL_TIMEOUT_EXPIRED) {
+			stats.stalls++;
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			while (status == GL_TIMEOUT_EXPIRED) {
+				status = glClientWaitSync(fences[r], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+			}
+			stats.stallMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		}
+		glDeleteSync(fences[r]);
+		fences[r] = 0;
+	}
+};
+
+#endif // !FRAMERING_H
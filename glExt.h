@@ -0,0 +1,99 @@
+// Valor engine by Valores M.
+// Extension checks and entry points newer than the GL 4.3 core glad was generated for
+#ifndef GLEXT_H
+#define GLEXT_H
+
+#include <glad/glad.h>
+
+#include <string>
+#include <vector>
+
+// GL_KHR_parallel_shader_compile (the ARB version uses the same values)
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+// GL_ARB_gl_spirv
+#ifndef GL_SHADER_BINARY_FORMAT_SPIR_V_ARB
+#define GL_SHADER_BINARY_FORMAT_SPIR_V_ARB 0x9551
+#define GL_SPIR_V_BINARY_ARB 0x9552
+#endif
+
+// GL_ARB_buffer_storage (core in 4.4)
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
+#define GL_CLIENT_STORAGE_BIT 0x0200
+#endif
+
+typedef void (APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
+typedef void (APIENTRYP PFNGLBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+typedef void (APIENTRYP PFNGLSPECIALIZESHADERARBPROC)(GLuint shader, const GLchar* pEntryPoint, GLuint numSpecializationConstants, const GLuint* pConstantIndex, const GLuint* pConstantValue);
+
+class GLExt {
+public:
+	bool parallelShaderCompile = false;
+	PFNGLMAXSHADERCOMPILERTHREADSKHRPROC maxShaderCompilerThreads = nullptr;
+	bool spirv = false;
+	// immutable storage, needed for persistent mapping (core in 4.4)
+	PFNGLBUFFERSTORAGEPROC bufferStorage = nullptr;
+	// gl_BaseInstanceARB/gl_DrawIDARB in GLSL (core in 4.6)
+	bool drawParameters = false;
+	PFNGLSPECIALIZESHADERARBPROC specializeShader = nullptr;
+
+	static GLExt& get() {
+		static GLExt ext;
+		return ext;
+	}
+	// Call right after gladLoadGLLoader with the same loader
+	void load(GLADloadproc loader) {
+		extensions.clear();
+		GLint count = 0;
+		glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+		for (GLint i = 0; i < count; i++) {
+			const GLubyte* name = glGetStringi(GL_EXTENSIONS, (GLuint)i);
+			if (name) {
+				extensions.push_back((const char*)name);
+			}
+		}
+		if (has("GL_KHR_parallel_shader_compile")) {
+			parallelShaderCompile = true;
+			maxShaderCompilerThreads = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)loader("glMaxShaderCompilerThreadsKHR");
+		}
+		else if (has("GL_ARB_parallel_shader_compile")) {
+			parallelShaderCompile = true;
+			maxShaderCompilerThreads = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)loader("glMaxShaderCompilerThreadsARB");
+		}
+		// core in 4.6 as glSpecializeShader, same entry point either way
+		if (has("GL_ARB_gl_spirv")) {
+			specializeShader = (PFNGLSPECIALIZESHADERARBPROC)loader("glSpecializeShaderARB");
+			if (specializeShader == nullptr) {
+				specializeShader = (PFNGLSPECIALIZESHADERARBPROC)loader("glSpecializeShader");
+			}
+			spirv = specializeShader != nullptr;
+		}
+		drawParameters = has("GL_ARB_shader_draw_parameters");
+		if (has("GL_ARB_buffer_storage")) {
+			bufferStorage = (PFNGLBUFFERSTORAGEPROC)loader("glBufferStorage");
+		}
+		loaded = true;
+	}
+	bool has(const char* name) const {
+		for (size_t i = 0; i < extensions.size(); i++) {
+			if (extensions[i] == name) {
+				return true;
+			}
+		}
+		return false;
+	}
+	bool isLoaded() const {
+		return loaded;
+	}
+private:
+	std::vector<std::string> extensions;
+	bool loaded = false;
+};
+
+#endif // !GLEXT_H
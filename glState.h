@@ -0,0 +1,279 @@
+// Valor engine by Valores M.
+// Shadow copy of the GL binding state, drops calls that would not change anything
+#ifndef GLSTATE_H
+#define GLSTATE_H
+
+#include <glad/glad.h>
+
+#include <iostream>
+
+enum GLStateCall {
+	SK_GL_PROGRAM,
+	SK_GL_VAO,
+	SK_GL_BUFFER,
+	SK_GL_TEXTURE,
+	SK_GL_SAMPLER,
+	SK_GL_BLEND,
+	SK_GL_DEPTH,
+	SK_GL_CALL_COUNT
+};
+
+struct GLStateStats {
+	unsigned int issued[SK_GL_CALL_COUNT] = {};
+	unsigned int skipped[SK_GL_CALL_COUNT] = {};
+
+	unsigned int totalIssued() const {
+		unsigned int n = 0;
+		for (int i = 0; i < SK_GL_CALL_COUNT; i++) {
+			n += issued[i];
+		}
+		return n;
+	}
+	unsigned int totalSkipped() const {
+		unsigned int n = 0;
+		for (int i = 0; i < SK_GL_CALL_COUNT; i++) {
+			n += skipped[i];
+		}
+		return n;
+	}
+};
+
+// Route program, VAO, buffer, texture, sampler, blend and depth changes through here.
+// One context, GL thread only. Code that changes this state behind its back (or a
+// context loss) must call invalidate() so the next call of each kind is issued again
+class GLState {
+public:
+	static const int maxTextureUnits = 32;
+
+	static GLState& get() {
+		static GLState state;
+		return state;
+	}
+	// Starts a new frame of counters, the finished frame stays readable in lastFrame()
+	void beginFrame() {
+		previous = current;
+		current = GLStateStats();
+	}
+	const GLStateStats& frame() const {
+		return current;
+	}
+	const GLStateStats& lastFrame() const {
+		return previous;
+	}
+	void invalidate() {
+		program = unknown;
+		vertexArray = unknown;
+		for (int i = 0; i < bufferTargetCount; i++) {
+			buffers[i] = unknown;
+		}
+		activeUnit = unknown;
+		for (int u = 0; u < maxTextureUnits; u++) {
+			for (int t = 0; t < textureTargetCount; t++) {
+				textures[u][t] = unknown;
+			}
+			samplers[u] = unknown;
+		}
+		blend = -1;
+		blendSrc = unknown;
+		blendDst = unknown;
+		depthTest = -1;
+		depthWrite = -1;
+		depthFunc = unknown;
+	}
+
+	void useProgram(GLuint id) {
+		if (check(SK_GL_PROGRAM, program == id)) {
+			return;
+		}
+		program = id;
+		glUseProgram(id);
+	}
+	// The element buffer binding belongs to the VAO, so it is unknown after a switch
+	void bindVertexArray(GLuint id) {
+		if (check(SK_GL_VAO, vertexArray == id)) {
+			return;
+		}
+		vertexArray = id;
+		buffers[bufferSlot(GL_ELEMENT_ARRAY_BUFFER)] = unknown;
+		glBindVertexArray(id);
+	}
+	void bindBuffer(GLenum target, GLuint id) {
+		int slot = bufferSlot(target);
+		if (check(SK_GL_BUFFER, slot >= 0 && buffers[slot] == id)) {
+			return;
+		}
+		if (slot >= 0) {
+			buffers[slot] = id;
+		}
+		glBindBuffer(target, id);
+	}
+	// Indexed bindings are not tracked, but GL also moves the generic binding point
+	void bindBufferBase(GLenum target, GLuint index, GLuint id) {
+		int slot = bufferSlot(target);
+		if (slot >= 0) {
+			buffers[slot] = id;
+		}
+		check(SK_GL_BUFFER, false);
+		glBindBufferBase(target, index, id);
+	}
+	void bindBufferRange(GLenum target, GLuint index, GLuint id, GLintptr offset, GLsizeiptr size) {
+		int slot = bufferSlot(target);
+		if (slot >= 0) {
+			buffers[slot] = id;
+		}
+		check(SK_GL_BUFFER, false);
+		glBindBufferRange(target, index, id, offset, size);
+	}
+	// Selects the unit only when the binding really changes
+	void bindTexture(GLuint unit, GLenum target, GLuint id) {
+		int slot = textureSlot(target);
+		bool cached = unit < (GLuint)maxTextureUnits && slot >= 0;
+		if (check(SK_GL_TEXTURE, cached && textures[unit][slot] == id)) {
+			return;
+		}
+		if (cached) {
+			textures[unit][slot] = id;
+		}
+		if (activeUnit != unit) {
+			activeUnit = unit;
+			glActiveTexture(GL_TEXTURE0 + unit);
+		}
+		glBindTexture(target, id);
+	}
+	void bindSampler(GLuint unit, GLuint id) {
+		bool cached = unit < (GLuint)maxTextureUnits;
+		if (check(SK_GL_SAMPLER, cached && samplers[unit] == id)) {
+			return;
+		}
+		if (cached) {
+			samplers[unit] = id;
+		}
+		glBindSampler(unit, id);
+	}
+	void setBlend(bool enabled) {
+		if (check(SK_GL_BLEND, blend == (int)enabled)) {
+			return;
+		}
+		blend = (int)enabled;
+		enabled ? glEnable(GL_BLEND) : glDisable(GL_BLEND);
+	}
+	void blendFunc(GLenum src, GLenum dst) {
+		if (check(SK_GL_BLEND, blendSrc == src && blendDst == dst)) {
+			return;
+		}
+		blendSrc = src;
+		blendDst = dst;
+		glBlendFunc(src, dst);
+	}
+	void setDepthTest(bool enabled) {
+		if (check(SK_GL_DEPTH, depthTest == (int)enabled)) {
+			return;
+		}
+		depthTest = (int)enabled;
+		enabled ? glEnable(GL_DEPTH_TEST) : glDisable(GL_DEPTH_TEST);
+	}
+	void depthMask(bool write) {
+		if (check(SK_GL_DEPTH, depthWrite == (int)write)) {
+			return;
+		}
+		depthWrite = (int)write;
+		glDepthMask(write ? GL_TRUE : GL_FALSE);
+	}
+	void setDepthFunc(GLenum func) {
+		if (check(SK_GL_DEPTH, depthFunc == func)) {
+			return;
+		}
+		depthFunc = func;
+		glDepthFunc(func);
+	}
+	// Forget a deleted object, GL unbinds it but a new object may reuse the name
+	void forgetBuffer(GLuint id) {
+		for (int i = 0; i < bufferTargetCount; i++) {
+			if (buffers[i] == id) {
+				buffers[i] = unknown;
+			}
+		}
+	}
+	void forgetTexture(GLuint id) {
+		for (int u = 0; u < maxTextureUnits; u++) {
+			for (int t = 0; t < textureTargetCount; t++) {
+				if (textures[u][t] == id) {
+					textures[u][t] = unknown;
+				}
+			}
+		}
+	}
+	void forgetVertexArray(GLuint id) {
+		if (vertexArray == id) {
+			vertexArray = unknown;
+		}
+	}
+	void report(const GLStateStats& stats) const {
+		static const char* names[SK_GL_CALL_COUNT] = { "program", "vao", "buffer", "texture", "sampler", "blend", "depth" };
+		std::cout << "GL::STATE issued " << stats.totalIssued() << " skipped " << stats.totalSkipped();
+		for (int i = 0; i < SK_GL_CALL_COUNT; i++) {
+			if (stats.issued[i] + stats.skipped[i] > 0) {
+				std::cout << " | " << names[i] << " " << stats.issued[i] << "/" << stats.skipped[i];
+			}
+		}
+		std::cout << std::endl;
+	}
+private:
+	static const GLuint unknown = 0xFFFFFFFFu;
+	static const int bufferTargetCount = 8;
+	static const int textureTargetCount = 4;
+
+	GLStateStats current;
+	GLStateStats previous;
+	GLuint program;
+	GLuint vertexArray;
+	GLuint buffers[bufferTargetCount];
+	GLuint activeUnit;
+	GLuint textures[maxTextureUnits][textureTargetCount];
+	GLuint samplers[maxTextureUnits];
+	int blend;
+	GLenum blendSrc;
+	GLenum blendDst;
+	int depthTest;
+	int depthWrite;
+	GLenum depthFunc;
+
+	// starts unknown so whatever the context was left in gets overwritten once
+	GLState() {
+		invalidate();
+	}
+	// counts the call, true when it can be skipped
+	bool check(GLStateCall call, bool redundant) {
+		if (redundant) {
+			current.skipped[call]++;
+		}
+		else {
+			current.issued[call]++;
+		}
+		return redundant;
+	}
+	static int bufferSlot(GLenum target) {
+		switch (target) {
+		case GL_ARRAY_BUFFER: return 0;
+		case GL_ELEMENT_ARRAY_BUFFER: return 1;
+		case GL_UNIFORM_BUFFER: return 2;
+		case GL_SHADER_STORAGE_BUFFER: return 3;
+		case GL_DRAW_INDIRECT_BUFFER: return 4;
+		case GL_COPY_READ_BUFFER: return 5;
+		case GL_COPY_WRITE_BUFFER: return 6;
+		case GL_PIXEL_UNPACK_BUFFER: return 7;
+		default: return -1;
+		}
+	}
+	static int textureSlot(GLenum target) {
+		switch (target) {
+		case GL_TEXTURE_2D: return 0;
+		case GL_TEXTURE_CUBE_MAP: return 1;
+		case GL_TEXTURE_2D_ARRAY: return 2;
+		case GL_TEXTURE_3D: return 3;
+		default: return -1;
+		}
+	}
+};
+
+#endif // !GLSTATE_H
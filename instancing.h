@@ -0,0 +1,109 @@
+// Valor engine by Valores M.
+// Automatic instancing: draws sharing program, mesh and material collapse into one call
+#ifndef INSTANCING_H
+#define INSTANCING_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <tuple>
+#include <vector>
+
+#include "glState.h"
+#include "drawData.h"
+#include "material.h"
+
+// One object to draw this frame. The mesh is the VAO plus the vertex (or index) range, so
+// two objects share a mesh when all of those match. indexType 0 means glDrawArrays style
+struct DrawItem {
+	GLuint program = 0;
+	GLuint vertexArray = 0;
+	GLenum mode = GL_TRIANGLES;
+	GLint first = 0;
+	GLsizei count = 0;
+	GLenum indexType = 0;
+	int material = -1;
+	// column-major 16 floats, copied on submit
+	const float* model = nullptr;
+};
+
+struct InstancingStats {
+	size_t submitted = 0;
+	size_t issued = 0;
+
+	size_t saved() const {
+		return submitted - issued;
+	}
+};
+
+// Submitted draws are grouped by (program, mesh, material). Each group's model matrices go
+// into consecutive DrawData records, which the index attribute (divisor 1) or
+// gl_BaseInstanceARB + gl_InstanceID walks, so a group is one
+// glDrawArraysInstancedBaseInstance / glDrawElementsInstancedBaseInstance with the first
+// record as base instance
+class InstanceBatcher {
+public:
+	void submit(const DrawItem& item) {
+		queue.push(item);
+	}
+	// Writes every record into drawData (reset first), uploads it and issues one call per
+	// group. materials may be nullptr when no item uses one, ring streams the records
+	void flush(DrawDataBuffer& drawData, MaterialLibrary* materials, FrameRing* ring = nullptr) {
+		current = InstancingStats();
+		current.submitted = queue.size();
+		order.resize(queue.size());
+		for (size_t i = 0; i < order.size(); i++) {
+			order[i] = (uint32_t)i;
+		}
+		std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+			return lessGroup(queue[a].draw, queue[b].draw);
+		});
+		buildDrawRuns(queue, order, drawData, ring, groups, sameGroup);
+
+		GLState& state = GLState::get();
+		for (size_t g = 0; g < groups.size(); g++) {
+			const DrawItem& item = queue[groups[g].draw].draw;
+			state.useProgram(item.program);
+			state.bindVertexArray(item.vertexArray);
+			if (materials != nullptr && item.material >= 0) {
+				materials->bind(item.material);
+			}
+			drawRunInstanced(item.mode, item.first, item.count, item.indexType, groups[g]);
+			current.issued++;
+		}
+		total.submitted += current.submitted;
+		total.issued += current.issued;
+		queue.clear();
+	}
+	// Counts of the last flush
+	const InstancingStats& frame() const {
+		return current;
+	}
+	const InstancingStats& lifetime() const {
+		return total;
+	}
+	void report(const InstancingStats& stats) const {
+		double percent = stats.submitted ? 100.0 * (double)stats.saved() / (double)stats.submitted : 0.0;
+		std::cout << "INSTANCING::DRAWS submitted " << stats.submitted << " issued " << stats.issued << " saved " << stats.saved() << " (" << percent << "%)" << std::endl;
+	}
+private:
+	DrawQueue<DrawItem> queue;
+	std::vector<uint32_t> order;
+	std::vector<DrawRun> groups;
+	InstancingStats current;
+	InstancingStats total;
+
+	static bool sameGroup(const DrawItem& a, const DrawItem& b) {
+		return a.program == b.program && a.vertexArray == b.vertexArray && a.mode == b.mode
+			&& a.first == b.first && a.count == b.count && a.indexType == b.indexType && a.material == b.material;
+	}
+	// program first, it is the most expensive switch
+	static bool lessGroup(const DrawItem& a, const DrawItem& b) {
+		return std::tie(a.program, a.vertexArray, a.material, a.mode, a.indexType, a.first, a.count)
+			< std::tie(b.program, b.vertexArray, b.material, b.mode, b.indexType, b.first, b.count);
+	}
+};
+
+#endif // !INSTANCING_H
@@ -0,0 +1,217 @@
+// Valor engine by Valores M.
+// Materials: per-program parameter blocks packed std140 into one shared uniform buffer
+#ifndef MATERIAL_H
+#define MATERIAL_H
+
+#include <glad/glad.h>
+#include <glm.hpp>
+
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "shader.h"
+#include "glState.h"
+#include "uniformBuffers.h"
+
+// How one C++ value is stored in a block member. Offsets and the matrix stride come from
+// reflection (BlockMemberInfo), so nothing here restates the std140 rules
+template<class T>
+struct MaterialParam;
+template<>
+struct MaterialParam<float> {
+	static void write(unsigned char* dst, const BlockMemberInfo&, const float& value) {
+		memcpy(dst, &value, sizeof(float));
+	}
+};
+template<>
+struct MaterialParam<int> {
+	static void write(unsigned char* dst, const BlockMemberInfo&, const int& value) {
+		int32_t v = value;
+		memcpy(dst, &v, sizeof(v));
+	}
+};
+// GLSL bool is a 4 byte uint in a block
+template<>
+struct MaterialParam<bool> {
+	static void write(unsigned char* dst, const BlockMemberInfo&, const bool& value) {
+		uint32_t v = value ? 1u : 0u;
+		memcpy(dst, &v, sizeof(v));
+	}
+};
+template<>
+struct MaterialParam<glm::vec3> {
+	static void write(unsigned char* dst, const BlockMemberInfo&, const glm::vec3& value) {
+		memcpy(dst, &value[0], 3 * sizeof(float));
+	}
+};
+template<>
+struct MaterialParam<glm::vec4> {
+	static void write(unsigned char* dst, const BlockMemberInfo&, const glm::vec4& value) {
+		memcpy(dst, &value[0], 4 * sizeof(float));
+	}
+};
+template<>
+struct MaterialParam<glm::mat4> {
+	static void write(unsigned char* dst, const BlockMemberInfo& member, const glm::mat4& value) {
+		for (int c = 0; c < 4; c++) {
+			memcpy(dst + c * member.matrixStride, &value[c][0], 4 * sizeof(float));
+		}
+	}
+};
+template<>
+struct MaterialParam<Vect3<float>> {
+	static void write(unsigned char* dst, const BlockMemberInfo&, const Vect3<float>& value) {
+		float v[3] = { value.x, value.y, value.z };
+		memcpy(dst, v, sizeof(v));
+	}
+};
+template<>
+struct MaterialParam<Mat4x4<float>> {
+	static void write(unsigned char* dst, const BlockMemberInfo& member, const Mat4x4<float>& value) {
+		for (int c = 0; c < 4; c++) {
+			memcpy(dst + c * member.matrixStride, value.data() + c * 4, 4 * sizeof(float));
+		}
+	}
+};
+
+// A program opts in by declaring its parameters as
+//   layout (std140, binding = 2) uniform MaterialData { ... };
+// addLayout copies that block's reflected layout, create() reserves a zeroed slot for it in
+// one CPU blob and set() packs values into it. upload() sends the whole blob as one buffer,
+// so switching material in the loop is a glBindBufferRange to another offset instead of a
+// run of glUniform calls. Layouts are taken at load time: a reload that changes the block
+// needs the materials rebuilt
+class MaterialLibrary {
+public:
+	GLuint buffer = 0;
+
+	// Index of the program's material layout, -1 when it has no MaterialData block.
+	// Programs sharing the same block (by name and size) share the layout
+	int addLayout(const Shader& shader) {
+		const UniformBlockInfo* block = shader.uniformBlockAt(SK_UBO_MATERIAL);
+		if (block == nullptr) {
+			std::cout << "ERROR::MATERIAL::NO_MATERIAL_BLOCK\nprogram " << shader.ID << " has no block at binding " << SK_UBO_MATERIAL << std::endl;
+			return -1;
+		}
+		for (size_t i = 0; i < layouts.size(); i++) {
+			if (layouts[i].hash == block->hash && layouts[i].dataSize == block->dataSize) {
+				return (int)i;
+			}
+		}
+		layouts.push_back(*block);
+		return (int)layouts.size() - 1;
+	}
+	// New material with every parameter zero, -1 for an invalid layout
+	int create(int layout) {
+		if (layout < 0 || layout >= (int)layouts.size()) {
+			return -1;
+		}
+		Entry e;
+		e.layout = layout;
+		e.offset = blob.size();
+		e.size = (size_t)layouts[layout].dataSize;
+		// every slot starts on a legal glBindBufferRange offset
+		blob.resize(e.offset + alignUp(e.size, offsetAlignment()), 0);
+		materials.push_back(e);
+		dirty = true;
+		return (int)materials.size() - 1;
+	}
+	// Writes into the CPU copy, index selects an array element. Visible after upload()
+	template<class T>
+	bool set(int material, uint32_t nameHash, const T& value, int index = 0) {
+		if (material < 0 || material >= (int)materials.size()) {
+			return false;
+		}
+		const Entry& e = materials[material];
+		const BlockMemberInfo* member = layouts[e.layout].member(nameHash);
+		if (member == nullptr) {
+			std::cout << "ERROR::MATERIAL::NO_SUCH_PARAMETER\nblock " << layouts[e.layout].name << " material " << material << std::endl;
+			return false;
+		}
+		if (!UniformType<T>::accepts(member->type) || index < 0 || index >= member->size) {
+			std::cout << "ERROR::MATERIAL::PARAMETER_TYPE_MISMATCH\n" << member->name << " is GL type 0x" << std::hex << member->type << std::dec << std::endl;
+			return false;
+		}
+		MaterialParam<T>::write(&blob[e.offset + member->offset + index * member->arrayStride], *member, value);
+		dirty = true;
+		return true;
+	}
+	// One transfer for every material, meant for load time or after edits
+	void upload() {
+		if (!dirty || blob.empty()) {
+			return;
+		}
+		if (buffer == 0) {
+			glGenBuffers(1, &buffer);
+		}
+		GLState::get().bindBuffer(GL_UNIFORM_BUFFER, buffer);
+		if (blob.size() != capacity) {
+			glBufferData(GL_UNIFORM_BUFFER, (GLsizeiptr)blob.size(), blob.data(), GL_STATIC_DRAW);
+			capacity = blob.size();
+		}
+		else {
+			glBufferSubData(GL_UNIFORM_BUFFER, 0, (GLsizeiptr)blob.size(), blob.data());
+		}
+		dirty = false;
+		bound = -1;
+	}
+	// Points SK_UBO_MATERIAL at the material's slot, nothing when it is already there
+	void bind(int material) {
+		if (material == bound || material < 0 || material >= (int)materials.size()) {
+			return;
+		}
+		const Entry& e = materials[material];
+		GLState::get().bindBufferRange(GL_UNIFORM_BUFFER, SK_UBO_MATERIAL, buffer, (GLintptr)e.offset, (GLsizeiptr)e.size);
+		bound = material;
+	}
+	// The binding point is shared GL state, call when something else may have moved it
+	void invalidate() {
+		bound = -1;
+	}
+	void destroy() {
+		GLState::get().forgetBuffer(buffer);
+		glDeleteBuffers(1, &buffer);
+		buffer = 0;
+		capacity = 0;
+		dirty = true;
+		bound = -1;
+	}
+	size_t count() const {
+		return materials.size();
+	}
+	size_t bytes() const {
+		return blob.size();
+	}
+	void report() const {
+		std::cout << "MATERIAL::LIBRARY " << materials.size() << " materials, " << layouts.size() << " layouts, " << blob.size() << " bytes in one buffer" << std::endl;
+	}
+private:
+	struct Entry {
+		int layout;
+		size_t offset;
+		size_t size;
+	};
+	std::vector<UniformBlockInfo> layouts;
+	std::vector<Entry> materials;
+	std::vector<unsigned char> blob;
+	size_t capacity = 0;
+	bool dirty = false;
+	int bound = -1;
+
+	static size_t alignUp(size_t size, size_t alignment) {
+		return (size + alignment - 1) / alignment * alignment;
+	}
+	static size_t offsetAlignment() {
+		static GLint alignment = 0;
+		if (alignment <= 0) {
+			glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+			if (alignment <= 0) {
+				alignment = 256;
+			}
+		}
+		return (size_t)alignment;
+	}
+};
+
+#endif // !MATERIAL_H
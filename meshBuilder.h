@@ -0,0 +1,152 @@
+// Valor engine by Valores M.
+// Mesh builder: welds duplicate vertices and emits the smallest index type that fits
+#ifndef MESHBUILDER_H
+#define MESHBUILDER_H
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+#include "skHash.h"
+#include "glState.h"
+
+struct MeshWeldStats {
+	size_t inputVertices = 0;
+	size_t uniqueVertices = 0;
+	size_t indices = 0;
+	// vertex shader runs per draw: glDrawArrays shades every vertex it is given, indexed
+	// draws only cache misses (estimated with a FIFO post-transform cache)
+	size_t shadedArrays = 0;
+	size_t shadedIndexed = 0;
+};
+
+// Vertices are floatsPerVertex floats compared bit for bit (-0.0 counts as 0.0), two input
+// vertices weld only when every attribute matches. The hash map goes from the FNV-1a hash of
+// a vertex to the first unique vertex with that hash, colliding vertices chain through next
+class MeshBuilder {
+public:
+	// post-transform cache size assumed by the estimate, small enough for any GPU
+	static const int cacheSize = 16;
+
+	explicit MeshBuilder(int floatsPerVertex = 5) : stride(floatsPerVertex) {
+		if (stride > maxFloats) {
+			std::cout << "ERROR::MESH::VERTEX_TOO_LARGE\n" << stride << " floats, at most " << maxFloats << std::endl;
+			stride = maxFloats;
+		}
+	}
+
+	// Index of an equal vertex already added, or of this one appended
+	uint32_t addVertex(const float* vertex) {
+		float v[maxFloats];
+		for (int i = 0; i < stride; i++) {
+			v[i] = vertex[i] == 0.0f ? 0.0f : vertex[i];
+		}
+		uint64_t hash = skHash64(v, stride * sizeof(float));
+		input++;
+		std::unordered_map<uint64_t, uint32_t>::iterator found = lookup.find(hash);
+		uint32_t chain = noVertex;
+		if (found != lookup.end()) {
+			chain = found->second;
+		}
+		uint32_t index = chain;
+		while (index != noVertex) {
+			if (memcmp(&vertexData[(size_t)index * stride], v, stride * sizeof(float)) == 0) {
+				indexData.push_back(index);
+				return index;
+			}
+			index = next[index];
+		}
+		index = (uint32_t)next.size();
+		vertexData.insert(vertexData.end(), v, v + stride);
+		next.push_back(chain);
+		lookup[hash] = index;
+		indexData.push_back(index);
+		return index;
+	}
+	// Non indexed triangle soup, the glDrawArrays layout
+	void addTriangles(const float* vertices, size_t vertexCount) {
+		for (size_t i = 0; i < vertexCount; i++) {
+			addVertex(vertices + i * stride);
+		}
+	}
+	size_t vertexCount() const {
+		return next.size();
+	}
+	GLsizei indexCount() const {
+		return (GLsizei)indexData.size();
+	}
+	// 16-bit while every index fits, half the index bandwidth
+	GLenum indexType() const {
+		return vertexCount() <= 0x10000 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+	}
+	const std::vector<float>& vertices() const {
+		return vertexData;
+	}
+	const std::vector<uint32_t>& indices() const {
+		return indexData;
+	}
+	// Fills both buffers. The element buffer binding is VAO state, bind the VAO first
+	void upload(GLuint vertexBuffer, GLuint indexBuffer) const {
+		GLState& state = GLState::get();
+		state.bindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+		glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(vertexData.size() * sizeof(float)), vertexData.data(), GL_STATIC_DRAW);
+		state.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+		if (indexType() == GL_UNSIGNED_SHORT) {
+			std::vector<uint16_t> narrow(indexData.begin(), indexData.end());
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)(narrow.size() * sizeof(uint16_t)), narrow.data(), GL_STATIC_DRAW);
+		}
+		else {
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)(indexData.size() * sizeof(uint32_t)), indexData.data(), GL_STATIC_DRAW);
+		}
+	}
+	MeshWeldStats statistics() const {
+		MeshWeldStats stats;
+		stats.inputVertices = input;
+		stats.uniqueVertices = vertexCount();
+		stats.indices = indexData.size();
+		stats.shadedArrays = indexData.size();
+		uint32_t cache[cacheSize];
+		int cached = 0;
+		int head = 0;
+		for (size_t i = 0; i < indexData.size(); i++) {
+			bool hit = false;
+			for (int c = 0; c < cached && !hit; c++) {
+				hit = cache[c] == indexData[i];
+			}
+			if (hit) {
+				continue;
+			}
+			stats.shadedIndexed++;
+			cache[head] = indexData[i];
+			head = (head + 1) % cacheSize;
+			if (cached < cacheSize) {
+				cached++;
+			}
+		}
+		return stats;
+	}
+	void report() const {
+		MeshWeldStats stats = statistics();
+		double saved = stats.shadedArrays ? 100.0 * (double)(stats.shadedArrays - stats.shadedIndexed) / (double)stats.shadedArrays : 0.0;
+		std::cout << "MESH::WELD vertices " << stats.inputVertices << " -> " << stats.uniqueVertices << " indices " << stats.indices
+			<< (indexType() == GL_UNSIGNED_SHORT ? " (16-bit)" : " (32-bit)") << " | vertex shader runs " << stats.shadedArrays
+			<< " -> " << stats.shadedIndexed << " (" << saved << "% fewer)" << std::endl;
+	}
+private:
+	static const int maxFloats = 32;
+	static const uint32_t noVertex = 0xFFFFFFFFu;
+
+	int stride;
+	size_t input = 0;
+	std::vector<float> vertexData;
+	std::vector<uint32_t> indexData;
+	// previous unique vertex with the same hash
+	std::vector<uint32_t> next;
+	std::unordered_map<uint64_t, uint32_t> lookup;
+};
+
+#endif // !MESHBUILDER_H
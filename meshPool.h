@@ -0,0 +1,96 @@
+// Valor engine by Valores M.
+// Many meshes in one vertex and one index buffer, so a single VAO and draw call reach them all
+#ifndef MESHPOOL_H
+#define MESHPOOL_H
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "glState.h"
+#include "drawData.h"
+
+// Where one mesh sits inside the pool, in the terms of DrawElementsIndirectCommand
+struct MeshRange {
+	GLuint firstIndex = 0;
+	GLuint indexCount = 0;
+	GLint baseVertex = 0;
+};
+
+// Vertices use valor's layout: position xyz then texcoord uv, 5 floats. Indices are 32-bit
+// and relative to the mesh, baseVertex moves them to the mesh's vertices at draw time.
+// Meshes are staged on the CPU and sent in one upload()
+class MeshPool {
+public:
+	static const int floatsPerVertex = 5;
+
+	GLuint vertexArray = 0;
+	GLuint vertexBuffer = 0;
+	GLuint indexBuffer = 0;
+
+	int add(const float* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount) {
+		MeshRange range;
+		range.firstIndex = (GLuint)indexData.size();
+		range.indexCount = (GLuint)indexCount;
+		range.baseVertex = (GLint)(vertexData.size() / floatsPerVertex);
+		vertexData.insert(vertexData.end(), vertices, vertices + vertexCount * floatsPerVertex);
+		indexData.insert(indexData.end(), indices, indices + indexCount);
+		ranges.push_back(range);
+		return (int)ranges.size() - 1;
+	}
+	// Non indexed mesh (glDrawArrays data), every vertex gets its own index
+	int addArrays(const float* vertices, size_t vertexCount) {
+		std::vector<uint32_t> indices(vertexCount);
+		for (size_t i = 0; i < vertexCount; i++) {
+			indices[i] = (uint32_t)i;
+		}
+		return add(vertices, vertexCount, indices.data(), vertexCount);
+	}
+	// Builds the VAO. With drawData the per-draw index attribute is attached too
+	void upload(DrawDataBuffer* drawData) {
+		GLState& state = GLState::get();
+		if (vertexArray == 0) {
+			glGenVertexArrays(1, &vertexArray);
+			glGenBuffers(1, &vertexBuffer);
+			glGenBuffers(1, &indexBuffer);
+		}
+		state.bindVertexArray(vertexArray);
+		state.bindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+		glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(vertexData.size() * sizeof(float)), vertexData.data(), GL_STATIC_DRAW);
+		state.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)(indexData.size() * sizeof(uint32_t)), indexData.data(), GL_STATIC_DRAW);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, floatsPerVertex * sizeof(float), (void*)0);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, floatsPerVertex * sizeof(float), (void*)(3 * sizeof(float)));
+		glEnableVertexAttribArray(1);
+		if (drawData != nullptr) {
+			drawData->attach(vertexArray);
+		}
+	}
+	const MeshRange& range(int mesh) const {
+		return ranges[mesh];
+	}
+	size_t meshCount() const {
+		return ranges.size();
+	}
+	size_t vertexCount() const {
+		return vertexData.size() / floatsPerVertex;
+	}
+	void destroy() {
+		GLState& state = GLState::get();
+		state.forgetVertexArray(vertexArray);
+		state.forgetBuffer(vertexBuffer);
+		state.forgetBuffer(indexBuffer);
+		glDeleteVertexArrays(1, &vertexArray);
+		glDeleteBuffers(1, &vertexBuffer);
+		glDeleteBuffers(1, &indexBuffer);
+		vertexArray = vertexBuffer = indexBuffer = 0;
+	}
+private:
+	std::vector<float> vertexData;
+	std::vector<uint32_t> indexData;
+	std::vector<MeshRange> ranges;
+};
+
+#endif // !MESHPOOL_H
@@ -0,0 +1,189 @@
+// Valor engine by Valores M.
+// On-disk cache of linked program binaries (glGetProgramBinary/glProgramBinary)
+#ifndef PROGRAMCACHE_H
+#define PROGRAMCACHE_H
+
+#include <glad/glad.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "skHash.h"
+
+#if defined(_WIN32)
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+struct ProgramCacheStats {
+	unsigned int hits = 0;
+	unsigned int misses = 0;
+	// binaries the driver refused (driver update, different GPU), recompiled from source
+	unsigned int rejected = 0;
+	double loadMs = 0.0;
+	double compileMs = 0.0;
+	// compile time recorded with each binary minus what loading it took
+	double savedMs = 0.0;
+};
+
+// One file per program under directory, named by the key. The key hashes both stage
+// sources plus GL_VENDOR/GL_RENDERER/GL_VERSION, so a driver change is a miss not a crash
+class ProgramBinaryCache {
+public:
+	std::string directory = "shadercache";
+	bool enabled = true;
+	ProgramCacheStats stats;
+
+	static ProgramBinaryCache& get() {
+		static ProgramBinaryCache cache;
+		return cache;
+	}
+	static double elapsedMs(std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+	uint64_t key(const std::string& vertexSource, const std::string& fragmentSource) {
+		if (driverHash == 0) {
+			driverHash = skHash64(glString(GL_VENDOR));
+			driverHash = skHash64(glString(GL_RENDERER), driverHash);
+			driverHash = skHash64(glString(GL_VERSION), driverHash);
+		}
+		// lengths go in too so moving text between the stages changes the key
+		uint64_t sizes[2] = { vertexSource.size(), fragmentSource.size() };
+		uint64_t h = skHash64(sizes, sizeof(sizes), driverHash);
+		h = skHash64(vertexSource, h);
+		return skHash64(fragmentSource, h);
+	}
+	// Linked program on a hit, 0 when there is no usable binary
+	GLuint load(uint64_t programKey) {
+		if (!available()) {
+			return 0;
+		}
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		std::ifstream file(path(programKey), std::ios::binary | std::ios::ate);
+		if (!file) {
+			stats.misses++;
+			return 0;
+		}
+		// opened at the end, so this is the file size
+		std::streamoff fileSize = file.tellg();
+		file.seekg(0);
+		BinaryHeader header;
+		std::vector<char> blob;
+		if (file.read((char*)&header, sizeof(header))) {
+			// a corrupt length must not turn into a huge allocation, it can't exceed the file
+			bool lengthFits = (std::streamoff)header.length <= fileSize - (std::streamoff)sizeof(header);
+			if (header.magic == fileMagic && header.version == fileVersion && header.key == programKey && lengthFits) {
+				blob.resize(header.length);
+				file.read(blob.data(), header.length);
+			}
+		}
+		if (blob.empty() || !file) {
+			stats.misses++;
+			stats.rejected++;
+			return 0;
+		}
+		GLuint program = glCreateProgram();
+		glProgramBinary(program, header.format, blob.data(), (GLsizei)blob.size());
+		GLint success = 0;
+		glGetProgramiv(program, GL_LINK_STATUS, &success);
+		if (!success) {
+			glDeleteProgram(program);
+			stats.misses++;
+			stats.rejected++;
+			return 0;
+		}
+		double ms = elapsedMs(start);
+		stats.hits++;
+		stats.loadMs += ms;
+		stats.savedMs += header.compileMs - ms;
+		return program;
+	}
+	// Call before glLinkProgram so the driver keeps the binary around
+	void prepare(GLuint program) {
+		if (available()) {
+			glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		}
+	}
+	void store(uint64_t programKey, GLuint program, double compileMs) {
+		stats.compileMs += compileMs;
+		if (!available()) {
+			return;
+		}
+		GLint length = 0;
+		glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+		if (length <= 0) {
+			return;
+		}
+		std::vector<char> blob(length);
+		BinaryHeader header;
+		header.key = programKey;
+		header.compileMs = compileMs;
+		GLenum format = 0;
+		glGetProgramBinary(program, length, NULL, &format, blob.data());
+		header.format = format;
+		header.length = (uint32_t)length;
+		makeDirectory();
+		// write then rename so a crash never leaves a truncated binary behind
+		std::string finalPath = path(programKey);
+		std::string tmpPath = finalPath + ".tmp";
+		{
+			std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+			if (!file) {
+				std::cout << "ERROR::SHADER::CACHE::WRITE_FAILED\n" << tmpPath << std::endl;
+				return;
+			}
+			file.write((const char*)&header, sizeof(header));
+			file.write(blob.data(), blob.size());
+		}
+		std::remove(finalPath.c_str());
+		std::rename(tmpPath.c_str(), finalPath.c_str());
+	}
+	void report() const {
+		std::cout << "SHADER::CACHE hits " << stats.hits << " misses " << stats.misses
+			<< " (rejected " << stats.rejected << ") load " << stats.loadMs << " ms compile "
+			<< stats.compileMs << " ms saved " << stats.savedMs << " ms" << std::endl;
+	}
+private:
+	static const uint32_t fileMagic = 0x43425356; // "VSBC"
+	static const uint32_t fileVersion = 1;
+	struct BinaryHeader {
+		uint32_t magic = fileMagic;
+		uint32_t version = fileVersion;
+		uint64_t key = 0;
+		uint32_t format = 0;
+		uint32_t length = 0;
+		double compileMs = 0.0;
+	};
+	uint64_t driverHash = 0;
+	int binaryFormats = -1;
+
+	bool available() {
+		if (binaryFormats < 0) {
+			glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binaryFormats);
+		}
+		return enabled && binaryFormats > 0;
+	}
+	static std::string glString(GLenum name) {
+		const GLubyte* str = glGetString(name);
+		return str ? std::string((const char*)str) : std::string();
+	}
+	std::string path(uint64_t programKey) const {
+		char name[32];
+		snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)programKey);
+		return directory + "/" + name;
+	}
+	void makeDirectory() const {
+#if defined(_WIN32)
+		_mkdir(directory.c_str());
+#else
+		mkdir(directory.c_str(), 0755);
+#endif
+	}
+};
+
+#endif // !PROGRAMCACHE_H
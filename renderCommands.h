@@ -0,0 +1,246 @@
+// Valor engine by Valores M.
+// Render command stream: every draw carries a 64-bit sort key, radix sorted before submission
+#ifndef RENDERCOMMANDS_H
+#define RENDERCOMMANDS_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "glState.h"
+#include "drawData.h"
+#include "material.h"
+#include "frameRing.h"
+
+// One draw. Same mesh description as DrawItem, plus what the key needs: layer, blending and
+// the textures. textures[u] goes to unit u, 0 leaves the unit as it is
+struct RenderCommand {
+	static const int textureUnits = 4;
+
+	uint8_t layer = 0;
+	bool translucent = false;
+	GLuint program = 0;
+	GLuint vertexArray = 0;
+	GLenum mode = GL_TRIANGLES;
+	GLint first = 0;
+	GLsizei count = 0;
+	GLenum indexType = 0;
+	int material = -1;
+	GLuint textures[textureUnits] = {};
+	// as DrawItem::model
+	const float* model = nullptr;
+};
+
+// Key layout, most significant bits first:
+//   opaque       layer 4 | 0 | program 10 | material 12 | texture 12 | depth 25
+//   translucent  layer 4 | 1 | far-to-near depth 25 | program 10 | material 12 | texture 12
+// Layers draw in order, opaque before translucent within a layer. Opaque draws group by
+// state and go front to back inside a group, translucent ones only care about distance.
+// Fields hold the low bits of GL names and material indices, a collision costs a state
+// change but never a wrong draw, the stream compares the real values
+namespace RenderKey {
+	const int depthBits = 25;
+	const int textureBits = 12;
+	const int materialBits = 12;
+	const int programBits = 10;
+	const int layerBits = 4;
+
+	inline uint64_t field(uint64_t value, int bits) {
+		return value & ((1ull << bits) - 1);
+	}
+	// depth01 is 0 at the near plane and 1 at the far plane
+	inline uint64_t quantizeDepth(float depth01) {
+		if (!(depth01 > 0.0f)) {
+			depth01 = 0.0f;
+		}
+		if (depth01 > 1.0f) {
+			depth01 = 1.0f;
+		}
+		// double, a float cannot hold 2^25 - 1 and would round into the next field
+		return (uint64_t)((double)depth01 * (double)((1u << depthBits) - 1));
+	}
+	inline uint64_t make(const RenderCommand& c, float depth01) {
+		uint64_t state = field(c.program, programBits) << (materialBits + textureBits)
+			| field((uint64_t)(c.material + 1), materialBits) << textureBits
+			| field(c.textures[0], textureBits);
+		uint64_t depth = quantizeDepth(depth01);
+		uint64_t key = field(c.layer, layerBits) << 60;
+		if (!c.translucent) {
+			return key | state << depthBits | depth;
+		}
+		depth = ((1ull << depthBits) - 1) - depth;
+		return key | 1ull << 59 | depth << (programBits + materialBits + textureBits) | state;
+	}
+}
+
+struct RenderCommandStats {
+	size_t commands = 0;
+	size_t draws = 0;
+	double sortMs = 0.0;
+	// changes between consecutive draws, what the sort is there to keep down
+	size_t programChanges = 0;
+	size_t materialChanges = 0;
+	size_t textureChanges = 0;
+	size_t vertexArrayChanges = 0;
+	size_t blendChanges = 0;
+};
+
+// submit() builds the key from the command and its view depth, flush() radix sorts the
+// keys, writes the DrawData records in sorted order and walks the commands through GLState.
+// Neighbours that still match exactly after the sort become one instanced draw, like the
+// InstanceBatcher groups. Translucent commands get alpha blending and no depth writes
+class RenderCommandStream {
+public:
+	// View depth range mapped onto the key's depth bits, normally the projection's planes
+	void setDepthRange(float nearPlane, float farPlane) {
+		depthNear = nearPlane;
+		depthScale = farPlane > nearPlane ? 1.0f / (farPlane - nearPlane) : 0.0f;
+	}
+	// viewDepth is the distance along the view direction (-z in view space)
+	void submit(const RenderCommand& command, float viewDepth) {
+		SortEntry e;
+		e.key = RenderKey::make(command, (viewDepth - depthNear) * depthScale);
+		e.index = queue.push(command);
+		entries.push_back(e);
+	}
+	// materials may be nullptr when no command uses one, ring streams the records
+	void flush(DrawDataBuffer& drawData, MaterialLibrary* materials, FrameRing* ring = nullptr) {
+		current = RenderCommandStats();
+		current.commands = queue.size();
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		radixSort();
+		current.sortMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		order.resize(entries.size());
+		for (size_t i = 0; i < entries.size(); i++) {
+			order[i] = entries[i].index;
+		}
+		buildDrawRuns(queue, order, drawData, ring, runs, sameDraw);
+
+		GLState& state = GLState::get();
+		const RenderCommand* previous = nullptr;
+		for (size_t r = 0; r < runs.size(); r++) {
+			const RenderCommand& c = queue[runs[r].draw].draw;
+			countChanges(previous, c);
+			if (previous == nullptr || previous->translucent != c.translucent) {
+				state.setBlend(c.translucent);
+				state.depthMask(!c.translucent);
+				if (c.translucent) {
+					state.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+				}
+			}
+			state.useProgram(c.program);
+			state.bindVertexArray(c.vertexArray);
+			for (int u = 0; u < RenderCommand::textureUnits; u++) {
+				if (c.textures[u] != 0) {
+					state.bindTexture(u, GL_TEXTURE_2D, c.textures[u]);
+				}
+			}
+			if (materials != nullptr && c.material >= 0) {
+				materials->bind(c.material);
+			}
+			drawRunInstanced(c.mode, c.first, c.count, c.indexType, runs[r]);
+			current.draws++;
+			previous = &c;
+		}
+		// leave the default state for whatever draws after the stream
+		if (previous != nullptr && previous->translucent) {
+			state.setBlend(false);
+			state.depthMask(true);
+		}
+		queue.clear();
+		entries.clear();
+	}
+	const RenderCommandStats& frame() const {
+		return current;
+	}
+	void report(const RenderCommandStats& stats) const {
+		std::cout << "RENDERCOMMANDS::SORT commands " << stats.commands << " draws " << stats.draws << " sort " << stats.sortMs << " ms"
+			<< " | changes program " << stats.programChanges << " material " << stats.materialChanges << " texture " << stats.textureChanges
+			<< " vao " << stats.vertexArrayChanges << " blend " << stats.blendChanges << std::endl;
+	}
+private:
+	struct SortEntry {
+		uint64_t key;
+		uint32_t index;
+	};
+	DrawQueue<RenderCommand> queue;
+	std::vector<SortEntry> entries;
+	std::vector<SortEntry> scratch;
+	std::vector<uint32_t> order;
+	std::vector<DrawRun> runs;
+	RenderCommandStats current;
+	float depthNear = 0.1f;
+	float depthScale = 1.0f / (100.0f - 0.1f);
+
+	// LSD radix sort, 8 passes of 8 bits. All histograms come from one read of the keys and
+	// a pass whose byte is the same for every key is skipped, so the unused high layer bits
+	// and a frame without translucent draws cost nothing. Stable, equal keys keep submit order
+	void radixSort() {
+		size_t n = entries.size();
+		if (n < 2) {
+			return;
+		}
+		size_t counts[8][256] = {};
+		for (size_t i = 0; i < n; i++) {
+			uint64_t key = entries[i].key;
+			for (int pass = 0; pass < 8; pass++) {
+				counts[pass][(key >> (pass * 8)) & 0xFF]++;
+			}
+		}
+		scratch.resize(n);
+		for (int pass = 0; pass < 8; pass++) {
+			int shift = pass * 8;
+			if (counts[pass][(entries[0].key >> shift) & 0xFF] == n) {
+				continue;
+			}
+			size_t offsets[256];
+			size_t sum = 0;
+			for (int b = 0; b < 256; b++) {
+				offsets[b] = sum;
+				sum += counts[pass][b];
+			}
+			for (size_t i = 0; i < n; i++) {
+				scratch[offsets[(entries[i].key >> shift) & 0xFF]++] = entries[i];
+			}
+			entries.swap(scratch);
+		}
+	}
+	void countChanges(const RenderCommand* previous, const RenderCommand& c) {
+		if (previous == nullptr) {
+			current.programChanges++;
+			current.vertexArrayChanges++;
+			current.blendChanges++;
+			current.materialChanges += c.material >= 0 ? 1 : 0;
+			for (int u = 0; u < RenderCommand::textureUnits; u++) {
+				current.textureChanges += c.textures[u] != 0 ? 1 : 0;
+			}
+			return;
+		}
+		current.programChanges += previous->program != c.program ? 1 : 0;
+		current.vertexArrayChanges += previous->vertexArray != c.vertexArray ? 1 : 0;
+		current.blendChanges += previous->translucent != c.translucent ? 1 : 0;
+		current.materialChanges += c.material >= 0 && previous->material != c.material ? 1 : 0;
+		for (int u = 0; u < RenderCommand::textureUnits; u++) {
+			current.textureChanges += c.textures[u] != 0 && previous->textures[u] != c.textures[u] ? 1 : 0;
+		}
+	}
+	static bool sameDraw(const RenderCommand& a, const RenderCommand& b) {
+		if (a.program != b.program || a.vertexArray != b.vertexArray || a.mode != b.mode || a.first != b.first || a.count != b.count
+			|| a.indexType != b.indexType || a.material != b.material || a.translucent != b.translucent || a.layer != b.layer) {
+			return false;
+		}
+		for (int u = 0; u < RenderCommand::textureUnits; u++) {
+			if (a.textures[u] != b.textures[u]) {
+				return false;
+			}
+		}
+		return true;
+	}
+};
+
+#endif // !RENDERCOMMANDS_H
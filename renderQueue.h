@@ -0,0 +1,158 @@
+// Valor engine by Valores M.
+// Render queue: draw packets over a MeshPool, submitted as glMultiDrawElementsIndirect
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <tuple>
+#include <vector>
+
+#include "glState.h"
+#include "drawData.h"
+#include "material.h"
+#include "meshPool.h"
+
+// Layout fixed by GL for GL_DRAW_INDIRECT_BUFFER
+struct DrawElementsIndirectCommand {
+	GLuint count;
+	GLuint instanceCount;
+	GLuint firstIndex;
+	GLint baseVertex;
+	GLuint baseInstance;
+};
+static_assert(sizeof(DrawElementsIndirectCommand) == 20, "indirect commands are 5 tightly packed ints");
+
+// One object: which program, which pool mesh, which material, where
+struct DrawPacket {
+	GLuint program = 0;
+	int mesh = 0;
+	int material = -1;
+	// as DrawItem::model
+	const float* model = nullptr;
+};
+
+struct RenderQueueStats {
+	size_t packets = 0;
+	// indirect commands, neighbours with the same mesh share one as instances
+	size_t commands = 0;
+	// glMultiDrawElementsIndirect calls, one per program/material bucket
+	size_t multiDraws = 0;
+};
+
+// Packets are sorted into (program, material) buckets, the only state that has to change
+// between draws: every mesh lives in the same MeshPool VAO and per-draw data is in the
+// DrawData SSBO. Each bucket becomes one glMultiDrawElementsIndirect over a slice of the
+// command buffer, whatever mix of meshes it holds. Command i of a bucket points its
+// baseInstance at the packet's DrawData record, the same indexing single draws use
+class RenderQueue {
+public:
+	GLuint commandBuffer = 0;
+
+	void submit(const DrawPacket& packet) {
+		queue.push(packet);
+	}
+	// ring, when given, carries both the DrawData records and the indirect commands
+	void flush(const MeshPool& meshes, DrawDataBuffer& drawData, MaterialLibrary* materials, FrameRing* ring = nullptr) {
+		current = RenderQueueStats();
+		current.packets = queue.size();
+		order.resize(queue.size());
+		for (size_t i = 0; i < order.size(); i++) {
+			order[i] = (uint32_t)i;
+		}
+		std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+			const DrawPacket& pa = queue[a].draw;
+			const DrawPacket& pb = queue[b].draw;
+			return std::tie(pa.program, pa.material, pa.mesh) < std::tie(pb.program, pb.material, pb.mesh);
+		});
+		// a repeat of the previous mesh is one more instance of its command
+		buildDrawRuns(queue, order, drawData, ring, runs, [](const DrawPacket& a, const DrawPacket& b) {
+			return a.program == b.program && a.material == b.material && a.mesh == b.mesh;
+		});
+		commands.clear();
+		buckets.clear();
+		for (size_t r = 0; r < runs.size(); r++) {
+			const DrawPacket& p = queue[runs[r].draw].draw;
+			if (buckets.empty() || buckets.back().program != p.program || buckets.back().material != p.material) {
+				Bucket b;
+				b.program = p.program;
+				b.material = p.material;
+				b.firstCommand = commands.size();
+				b.commandCount = 0;
+				buckets.push_back(b);
+			}
+			const MeshRange& range = meshes.range(p.mesh);
+			DrawElementsIndirectCommand cmd;
+			cmd.count = range.indexCount;
+			cmd.instanceCount = (GLuint)runs[r].instances;
+			cmd.firstIndex = range.firstIndex;
+			cmd.baseVertex = range.baseVertex;
+			cmd.baseInstance = runs[r].baseInstance;
+			commands.push_back(cmd);
+			buckets.back().commandCount++;
+		}
+		current.commands = commands.size();
+		queue.clear();
+		if (commands.empty()) {
+			return;
+		}
+
+		GLState& state = GLState::get();
+		size_t bytes = commands.size() * sizeof(DrawElementsIndirectCommand);
+		size_t base = 0;
+		RingAllocation slice;
+		if (ring != nullptr) {
+			slice = ring->write(commands.data(), bytes, sizeof(GLuint));
+		}
+		if (slice.valid()) {
+			state.bindBuffer(GL_DRAW_INDIRECT_BUFFER, ring->buffer);
+			base = (size_t)slice.offset;
+		}
+		else {
+			if (commandBuffer == 0) {
+				glGenBuffers(1, &commandBuffer);
+			}
+			state.bindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+			glBufferData(GL_DRAW_INDIRECT_BUFFER, (GLsizeiptr)bytes, commands.data(), GL_STREAM_DRAW);
+		}
+		state.bindVertexArray(meshes.vertexArray);
+		for (size_t b = 0; b < buckets.size(); b++) {
+			state.useProgram(buckets[b].program);
+			if (materials != nullptr && buckets[b].material >= 0) {
+				materials->bind(buckets[b].material);
+			}
+			const void* offset = (const void*)(base + buckets[b].firstCommand * sizeof(DrawElementsIndirectCommand));
+			glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, offset, (GLsizei)buckets[b].commandCount, 0);
+			current.multiDraws++;
+		}
+	}
+	const RenderQueueStats& frame() const {
+		return current;
+	}
+	void report(const RenderQueueStats& stats) const {
+		std::cout << "RENDERQUEUE::MDI packets " << stats.packets << " commands " << stats.commands << " multi draws " << stats.multiDraws << std::endl;
+	}
+	void destroy() {
+		GLState::get().forgetBuffer(commandBuffer);
+		glDeleteBuffers(1, &commandBuffer);
+		commandBuffer = 0;
+	}
+private:
+	struct Bucket {
+		GLuint program;
+		int material;
+		size_t firstCommand;
+		size_t commandCount;
+	};
+	DrawQueue<DrawPacket> queue;
+	std::vector<uint32_t> order;
+	std::vector<DrawRun> runs;
+	std::vector<DrawElementsIndirectCommand> commands;
+	std::vector<Bucket> buckets;
+	RenderQueueStats current;
+};
+
+#endif // !RENDERQUEUE_H
@@ -5,96 +5,728 @@
 #include <glm.hpp>
 
 #include <string>
-#include <fstream>
-#include <sstream>
+#include <vector>
 #include <iostream>
 
+#include "skHash.h"
+#include "skMath.h"
+#include "programCache.h"
+#include "glExt.h"
+#include "uniformBuffers.h"
+#include "shaderPreprocessor.h"
+#include "shaderSpirv.h"
+
+// Which reflected GL types a C++ value may be written to
+template<class T>
+struct UniformType;
+template<>
+struct UniformType<int> {
+	static bool accepts(GLenum type) {
+		switch (type) {
+		case GL_INT: case GL_BOOL:
+		case GL_SAMPLER_1D: case GL_SAMPLER_2D: case GL_SAMPLER_3D: case GL_SAMPLER_CUBE:
+		case GL_SAMPLER_2D_SHADOW: case GL_SAMPLER_2D_ARRAY: case GL_SAMPLER_2D_ARRAY_SHADOW:
+		case GL_SAMPLER_CUBE_SHADOW: case GL_SAMPLER_2D_MULTISAMPLE: case GL_SAMPLER_BUFFER:
+		case GL_INT_SAMPLER_2D: case GL_UNSIGNED_INT_SAMPLER_2D:
+			return true;
+		default:
+			return false;
+		}
+	}
+};
+template<>
+struct UniformType<bool> {
+	static bool accepts(GLenum type) { return type == GL_BOOL || type == GL_INT; }
+};
+template<>
+struct UniformType<float> {
+	static bool accepts(GLenum type) { return type == GL_FLOAT; }
+};
+template<>
+struct UniformType<glm::vec3> {
+	static bool accepts(GLenum type) { return type == GL_FLOAT_VEC3; }
+};
+template<>
+struct UniformType<glm::vec4> {
+	static bool accepts(GLenum type) { return type == GL_FLOAT_VEC4; }
+};
+template<>
+struct UniformType<glm::mat4> {
+	static bool accepts(GLenum type) { return type == GL_FLOAT_MAT4; }
+};
+template<>
+struct UniformType<Vect3<float>> {
+	static bool accepts(GLenum type) { return type == GL_FLOAT_VEC3; }
+};
+template<>
+struct UniformType<Mat4x4<float>> {
+	static bool accepts(GLenum type) { return type == GL_FLOAT_MAT4; }
+};
+
+// Typed location resolved once from the reflection table. set() is a single glUniform*
+// call on the bound program; an invalid handle (location -1) is ignored by GL like before
+template<class T>
+struct Uniform {
+	GLint location = -1;
+	bool valid() const {
+		return location >= 0;
+	}
+	void set(const T& value) const;
+};
+template<>
+inline void Uniform<int>::set(const int& value) const {
+	glUniform1i(location, value);
+}
+template<>
+inline void Uniform<bool>::set(const bool& value) const {
+	glUniform1i(location, (int)value);
+}
+template<>
+inline void Uniform<float>::set(const float& value) const {
+	glUniform1f(location, value);
+}
+template<>
+inline void Uniform<glm::vec3>::set(const glm::vec3& value) const {
+	glUniform3fv(location, 1, &value[0]);
+}
+template<>
+inline void Uniform<glm::vec4>::set(const glm::vec4& value) const {
+	glUniform4fv(location, 1, &value[0]);
+}
+template<>
+inline void Uniform<glm::mat4>::set(const glm::mat4& value) const {
+	glUniformMatrix4fv(location, 1, GL_FALSE, &value[0][0]);
+}
+template<>
+inline void Uniform<Vect3<float>>::set(const Vect3<float>& value) const {
+	glUniform3f(location, value.x, value.y, value.z);
+}
+template<>
+inline void Uniform<Mat4x4<float>>::set(const Mat4x4<float>& value) const {
+	glUniformMatrix4fv(location, 1, GL_FALSE, value.data());
+}
+
+// One reflected active uniform. Arrays are stored under their base name ("lights", not
+// "lights[0]") with the location of element 0; block members are not listed
+struct UniformInfo {
+	uint32_t hash = 0;
+	GLint location = -1;
+	GLenum type = 0;
+	GLint size = 0;
+	std::string name;
+};
+
+// One member of an active uniform block as the driver laid it out. For std140 blocks these
+// are the std140 rules, but reading them back means CPU packing never has to re-derive them
+struct BlockMemberInfo {
+	uint32_t hash = 0;
+	GLenum type = 0;
+	GLint size = 0;
+	GLint offset = 0;
+	GLint arrayStride = 0;
+	GLint matrixStride = 0;
+	std::string name;
+};
+struct UniformBlockInfo {
+	uint32_t hash = 0;
+	GLint binding = -1;
+	GLint dataSize = 0;
+	std::string name;
+	std::vector<BlockMemberInfo> members;
+
+	const BlockMemberInfo* member(uint32_t nameHash) const {
+		for (size_t i = 0; i < members.size(); i++) {
+			if (members[i].hash == nameHash) {
+				return &members[i];
+			}
+		}
+		return nullptr;
+	}
+};
 
 class Shader {
 public:
-	unsigned int ID;
+	unsigned int ID = 0;
 
+	Shader() {}
+	// Blocking: compiles, links and checks status before returning. Up to date SPIR-V
+	// modules are used when the driver takes them, the GLSL source otherwise
 	Shader(const char* vertexShaderPath, const char* fragmentShaderPath) {
 		std::string vertexShader;
 		std::string fragmentShader;
-		std::ifstream vShaderFile;
-		std::ifstream fShaderFile;
-
-		vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-		fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-		try {
-			// Load files
-			vShaderFile.open(vertexShaderPath);
-			fShaderFile.open(fragmentShaderPath);
-			std::stringstream vShaderStream, fShaderStream;
-			// Read file, buffer content into stream
-			vShaderStream << vShaderFile.rdbuf();
-			fShaderStream << fShaderFile.rdbuf();
-			// Close files
-			vShaderFile.close();
-			fShaderFile.close();
-			// conversion
-			vertexShader = vShaderStream.str();
-			fragmentShader = fShaderStream.str();
-		}
-		catch (std::ifstream::failure e) {
+		std::vector<std::string> files;
+		readSources(vertexShaderPath, fragmentShaderPath, vertexShader, fragmentShader, &files);
+		if (loadSpirv(vertexShaderPath, fragmentShaderPath, files)) {
+			return;
+		}
+		beginCompile(vertexShader, fragmentShader);
+		finishCompile();
+	};
+	// Both stages with #include expanded (see shaderPreprocessor.h). dependencies, when
+	// given, receives every file that was read so hot reload can follow includes too
+	static bool readSources(const char* vertexShaderPath, const char* fragmentShaderPath, std::string& vertexShader, std::string& fragmentShader, std::vector<std::string>* dependencies = nullptr) {
+		std::vector<std::string> vertexFiles, fragmentFiles;
+		bool ok = ShaderPreprocessor::expand(vertexShaderPath, vertexShader, vertexFiles);
+		ok = ShaderPreprocessor::expand(fragmentShaderPath, fragmentShader, fragmentFiles) && ok;
+		if (!ok) {
 			std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
 		}
+		if (dependencies != nullptr) {
+			*dependencies = vertexFiles;
+			dependencies->insert(dependencies->end(), fragmentFiles.begin(), fragmentFiles.end());
+		}
+		return ok;
+	}
+	// Queues compile and link without any status query so the driver can keep compiling
+	// while we submit more programs. A binary cache hit is complete straight away
+	void beginCompile(const std::string& vertexShader, const std::string& fragmentShader) {
+		ProgramBinaryCache& cache = ProgramBinaryCache::get();
+		cacheKey = cache.key(vertexShader, fragmentShader);
+		ID = cache.load(cacheKey);
+		if (ID != 0) {
+			reflectUniforms();
+			return;
+		}
+		compileStart = std::chrono::steady_clock::now();
 		const char* vShaderCode = vertexShader.c_str();
 		const char* fShaderCode = fragmentShader.c_str();
-		unsigned int vertex, fragment;
+		// vertex shader
+		vertexStage = glCreateShader(GL_VERTEX_SHADER);
+		glShaderSource(vertexStage, 1, &vShaderCode, NULL);
+		glCompileShader(vertexStage);
+		// frag shader
+		fragmentStage = glCreateShader(GL_FRAGMENT_SHADER);
+		glShaderSource(fragmentStage, 1, &fShaderCode, NULL);
+		glCompileShader(fragmentStage);
+		// shader program
+		ID = glCreateProgram();
+		glAttachShader(ID, vertexStage);
+		glAttachShader(ID, fragmentStage);
+		cache.prepare(ID);
+		glLinkProgram(ID);
+		pending = true;
+	}
+	// GL_ARB_gl_spirv path: glShaderBinary + glSpecializeShader on the modules next to the
+	// sources (ShaderSpirv::binaryPath). sources are the GLSL files they were built from.
+	// Returns false without touching ID when anything is missing, stale or rejected
+	bool loadSpirv(const char* vertexShaderPath, const char* fragmentShaderPath, const std::vector<std::string>& sources) {
+		if (!GLExt::get().spirv) {
+			return false;
+		}
+		std::string vertexBinary = ShaderSpirv::binaryPath(vertexShaderPath);
+		std::string fragmentBinary = ShaderSpirv::binaryPath(fragmentShaderPath);
+		if (!ShaderSpirv::upToDate(vertexBinary, sources) || !ShaderSpirv::upToDate(fragmentBinary, sources)) {
+			return false;
+		}
+		std::vector<uint32_t> vertexWords, fragmentWords;
+		if (!ShaderSpirv::load(vertexBinary, vertexWords) || !ShaderSpirv::load(fragmentBinary, fragmentWords)) {
+			std::cout << "ERROR::SHADER::SPIRV::BAD_MODULE\n" << vertexBinary << " / " << fragmentBinary << std::endl;
+			return false;
+		}
+		GLuint vertex = specializeStage(GL_VERTEX_SHADER, vertexWords, "VERTEX");
+		GLuint fragment = specializeStage(GL_FRAGMENT_SHADER, fragmentWords, "FRAGMENT");
+		GLuint program = 0;
+		if (vertex != 0 && fragment != 0) {
+			program = glCreateProgram();
+			glAttachShader(program, vertex);
+			glAttachShader(program, fragment);
+			glLinkProgram(program);
+			int success;
+			glGetProgramiv(program, GL_LINK_STATUS, &success);
+			if (!success) {
+				char infoLog[512];
+				glGetProgramInfoLog(program, 512, NULL, infoLog);
+				std::cout << "ERROR::SHADER::SPIRV::LINKING_FAILED\n" << infoLog << std::endl;
+				glDeleteProgram(program);
+				program = 0;
+			}
+		}
+		glDeleteShader(vertex);
+		glDeleteShader(fragment);
+		if (program == 0) {
+			return false;
+		}
+		ID = program;
+		ShaderSpirv::Names names;
+		ShaderSpirv::names(vertexWords, names);
+		ShaderSpirv::names(fragmentWords, names);
+		reflectUniforms(&names);
+		return true;
+	}
+	// Never blocks with KHR_parallel_shader_compile. Without it this is always true and
+	// finishCompile() waits on the driver instead
+	bool compileDone() const {
+		if (!pending || !GLExt::get().parallelShaderCompile) {
+			return true;
+		}
+		GLint done = 0;
+		glGetProgramiv(ID, GL_COMPLETION_STATUS_KHR, &done);
+		return done != 0;
+	}
+	bool isPending() const {
+		return pending;
+	}
+	// Status checks, error logs, binary cache store and uniform reflection
+	bool finishCompile() {
+		if (!pending) {
+			return ID != 0;
+		}
+		pending = false;
 		int success;
 		char infoLog[512];
-		// vertex shader
-		vertex = glCreateShader(GL_VERTEX_SHADER);
-		glShaderSource(vertex, 1, &vShaderCode, NULL);
-		glCompileShader(vertex);
 		// error check
-		glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
+		glGetShaderiv(vertexStage, GL_COMPILE_STATUS, &success);
 		if (!success) {
-			glGetShaderInfoLog(vertex, 512, NULL, infoLog);
+			glGetShaderInfoLog(vertexStage, 512, NULL, infoLog);
 			std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
 		};
-		// frag shader
-		fragment = glCreateShader(GL_FRAGMENT_SHADER);
-		glShaderSource(fragment, 1, &fShaderCode, NULL);
-		glCompileShader(fragment);
-		// error check
-		glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
+		glGetShaderiv(fragmentStage, GL_COMPILE_STATUS, &success);
 		if (!success) {
-			glGetShaderInfoLog(fragment, 512, NULL, infoLog);
+			glGetShaderInfoLog(fragmentStage, 512, NULL, infoLog);
 			std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
 		};
-		// shader program
-		ID = glCreateProgram();
-		glAttachShader(ID, vertex);
-		glAttachShader(ID, fragment);
-		glLinkProgram(ID);
-		// error check
-		glGetShaderiv(ID, GL_LINK_STATUS, &success);
+		glGetProgramiv(ID, GL_LINK_STATUS, &success);
 		if (!success) {
-			glGetShaderInfoLog(fragment, 512, NULL, infoLog);
+			glGetProgramInfoLog(ID, 512, NULL, infoLog);
 			std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
 		};
 		// clean up shaders
-		glDeleteShader(vertex);
-		glDeleteShader(fragment);
-	};
+		glDeleteShader(vertexStage);
+		glDeleteShader(fragmentStage);
+		vertexStage = 0;
+		fragmentStage = 0;
+		if (success) {
+			ProgramBinaryCache::get().store(cacheKey, ID, ProgramBinaryCache::elapsedMs(compileStart));
+		}
+		reflectUniforms();
+		return success != 0;
+	}
+	// Hot reload: take over a freshly linked program. Current uniform values are read back
+	// from the old program and written into the new one, then the old one is deleted.
+	// Locations can move, so cached Uniform<T> handles must be re-resolved when generation changes
+	void adoptProgram(Shader& fresh) {
+		fresh.copyUniformValues(*this);
+		glDeleteProgram(ID);
+		ID = fresh.ID;
+		uniformList.swap(fresh.uniformList);
+		uniformTable.swap(fresh.uniformTable);
+		blockList.swap(fresh.blockList);
+		fresh.ID = 0;
+		programGeneration++;
+	}
+	unsigned int generation() const {
+		return programGeneration;
+	}
 	void use() {
-		glUseProgram(ID);
+		GLState::get().useProgram(ID);
 	};
+	// Resolve once outside the render loop: shader.uniform<glm::mat4>(SK_HASH("model"))
+	template<class T>
+	Uniform<T> uniform(uint32_t nameHash) const {
+		Uniform<T> handle;
+		const UniformInfo* info = findUniform(nameHash);
+		if (info == nullptr) {
+			return handle;
+		}
+		if (!UniformType<T>::accepts(info->type)) {
+			std::cout << "ERROR::SHADER::UNIFORM_TYPE_MISMATCH\n" << info->name << " is GL type 0x" << std::hex << info->type << std::dec << std::endl;
+			return handle;
+		}
+		handle.location = info->location;
+		return handle;
+	}
+	GLint location(uint32_t nameHash) const {
+		const UniformInfo* info = findUniform(nameHash);
+		return info ? info->location : -1;
+	}
+	const std::vector<UniformInfo>& uniforms() const {
+		return uniformList;
+	}
+	const std::vector<UniformBlockInfo>& uniformBlocks() const {
+		return blockList;
+	}
+	// The active block read through binding point, nullptr when the program has none there
+	const UniformBlockInfo* uniformBlockAt(GLuint binding) const {
+		for (size_t i = 0; i < blockList.size(); i++) {
+			if (blockList[i].binding == (GLint)binding) {
+				return &blockList[i];
+			}
+		}
+		return nullptr;
+	}
+	// Name based setters hash at runtime but never ask the driver, prefer handles in loops
 	void setBool(const std::string& name, bool value) const {
-		glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+		glUniform1i(location(skHash32(name)), (int)value);
 	};
 	void setInt(const std::string& name, int value) const {
-		glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+		glUniform1i(location(skHash32(name)), value);
 	};
-	void setFloat(const std::string& name, GLint value) const {
-		glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+	void setFloat(const std::string& name, float value) const {
+		glUniform1f(location(skHash32(name)), value);
 	};
 	void setMat4(const std::string& name, glm::mat4x4& mat) const {
-		glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+		glUniformMatrix4fv(location(skHash32(name)), 1, GL_FALSE, &mat[0][0]);
+	};
+	// column-major 16 floats, e.g. straight out of TransformBatch
+	void setMat4(const std::string& name, const float* mat) const {
+		glUniformMatrix4fv(location(skHash32(name)), 1, GL_FALSE, mat);
 	};
+private:
+	// in flight between beginCompile and finishCompile
+	GLuint vertexStage = 0;
+	GLuint fragmentStage = 0;
+	uint64_t cacheKey = 0;
+	std::chrono::steady_clock::time_point compileStart;
+	bool pending = false;
+	unsigned int programGeneration = 0;
+
+	std::vector<UniformInfo> uniformList;
+	std::vector<UniformBlockInfo> blockList;
+	// open addressing over uniformList indices, power of two size, -1 is empty
+	std::vector<int> uniformTable;
+
+	// Compiled shader object or 0, errors are logged
+	static GLuint specializeStage(GLenum stage, const std::vector<uint32_t>& words, const char* label) {
+		GLuint shader = glCreateShader(stage);
+		glShaderBinary(1, &shader, GL_SHADER_BINARY_FORMAT_SPIR_V_ARB, words.data(), (GLsizei)(words.size() * 4));
+		GLExt::get().specializeShader(shader, "main", 0, nullptr, nullptr);
+		int success;
+		glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+		if (!success) {
+			char infoLog[512];
+			glGetShaderInfoLog(shader, 512, NULL, infoLog);
+			std::cout << "ERROR::SHADER::SPIRV::" << label << "::SPECIALIZATION_FAILED\n" << infoLog << std::endl;
+			glDeleteShader(shader);
+			return 0;
+		}
+		return shader;
+	}
+	// Lists every active uniform once after linking (GL_ACTIVE_UNIFORMS) and builds the table.
+	// SPIR-V programs have no usable names in GL, spirvNames supplies them by location
+	void reflectUniforms(const ShaderSpirv::Names* spirvNames = nullptr) {
+		bindUniformBlocks();
+		reflectUniformBlocks(spirvNames);
+		uniformList.clear();
+		GLint count = 0, maxLen = 0;
+		glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+		glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLen);
+		std::vector<char> nameBuf(maxLen > 0 ? maxLen : 1);
+		for (GLint i = 0; i < count; i++) {
+			GLsizei len = 0;
+			UniformInfo info;
+			glGetActiveUniform(ID, (GLuint)i, (GLsizei)nameBuf.size(), &len, &info.size, &info.type, nameBuf.data());
+			info.name.assign(nameBuf.data(), len);
+			if (spirvNames != nullptr) {
+				// name lookups are not defined for SPIR-V, the location comes from the resource
+				const GLenum property = GL_LOCATION;
+				glGetProgramResourceiv(ID, GL_UNIFORM, (GLuint)i, 1, &property, 1, NULL, &info.location);
+				for (size_t n = 0; n < spirvNames->uniforms.size(); n++) {
+					if (spirvNames->uniforms[n].location == info.location) {
+						info.name = spirvNames->uniforms[n].name;
+					}
+				}
+				if (info.name.empty()) {
+					continue;
+				}
+			}
+			else {
+				info.location = glGetUniformLocation(ID, info.name.c_str());
+			}
+			// uniform block members have no location, they go through buffers
+			if (info.location < 0) {
+				continue;
+			}
+			size_t bracket = info.name.find("[0]");
+			if (bracket != std::string::npos && bracket + 3 == info.name.size()) {
+				info.name.erase(bracket);
+			}
+			info.hash = skHash32(info.name);
+			uniformList.push_back(info);
+		}
+		size_t tableSize = 8;
+		while (tableSize < uniformList.size() * 2) {
+			tableSize *= 2;
+		}
+		uniformTable.assign(tableSize, -1);
+		for (size_t i = 0; i < uniformList.size(); i++) {
+			size_t slot = uniformList[i].hash & (tableSize - 1);
+			while (uniformTable[slot] >= 0) {
+				if (uniformList[uniformTable[slot]].hash == uniformList[i].hash) {
+					std::cout << "ERROR::SHADER::UNIFORM_HASH_COLLISION\n" << uniformList[i].name << " and " << uniformList[uniformTable[slot]].name << std::endl;
+				}
+				slot = (slot + 1) & (tableSize - 1);
+			}
+			uniformTable[slot] = (int)i;
+		}
+	}
+	// Points every active block that UniformBlockRegistry knows at its fixed binding
+	void bindUniformBlocks() {
+		GLint count = 0, maxLen = 0;
+		glGetProgramiv(ID, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+		glGetProgramiv(ID, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxLen);
+		std::vector<char> nameBuf(maxLen > 0 ? maxLen : 1);
+		for (GLint i = 0; i < count; i++) {
+			GLsizei len = 0;
+			glGetActiveUniformBlockName(ID, (GLuint)i, (GLsizei)nameBuf.size(), &len, nameBuf.data());
+			int binding = UniformBlockRegistry::get().bindingFor(skHash32(nameBuf.data(), len));
+			if (binding >= 0) {
+				glUniformBlockBinding(ID, (GLuint)i, (GLuint)binding);
+			}
+		}
+	}
+	// Active blocks with their final binding, size and member layout. GLSL names members
+	// "Block.member" when the block has an instance name, the prefix is dropped here
+	void reflectUniformBlocks(const ShaderSpirv::Names* spirvNames) {
+		blockList.clear();
+		GLint count = 0, maxBlockLen = 0, maxLen = 0;
+		glGetProgramiv(ID, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+		glGetProgramiv(ID, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxBlockLen);
+		glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLen);
+		std::vector<char> nameBuf((maxLen > maxBlockLen ? maxLen : maxBlockLen) + 1);
+		for (GLint i = 0; i < count; i++) {
+			UniformBlockInfo block;
+			GLint memberCount = 0, len = 0;
+			glGetActiveUniformBlockiv(ID, (GLuint)i, GL_UNIFORM_BLOCK_BINDING, &block.binding);
+			glGetActiveUniformBlockiv(ID, (GLuint)i, GL_UNIFORM_BLOCK_DATA_SIZE, &block.dataSize);
+			glGetActiveUniformBlockiv(ID, (GLuint)i, GL_UNIFORM_BLOCK_ACTIVE_UNIFORMS, &memberCount);
+			glGetActiveUniformBlockName(ID, (GLuint)i, (GLsizei)nameBuf.size(), &len, nameBuf.data());
+			block.name.assign(nameBuf.data(), len);
+			if (block.name.empty() && spirvNames != nullptr) {
+				for (size_t n = 0; n < spirvNames->blocks.size(); n++) {
+					if (spirvNames->blocks[n].binding == block.binding) {
+						block.name = spirvNames->blocks[n].name;
+					}
+				}
+			}
+			block.hash = skHash32(block.name);
+			std::vector<GLint> indices(memberCount > 0 ? memberCount : 1);
+			glGetActiveUniformBlockiv(ID, (GLuint)i, GL_UNIFORM_BLOCK_ACTIVE_UNIFORM_INDICES, indices.data());
+			for (GLint m = 0; m < memberCount; m++) {
+				GLuint index = (GLuint)indices[m];
+				BlockMemberInfo member;
+				GLint type = 0;
+				glGetActiveUniformsiv(ID, 1, &index, GL_UNIFORM_TYPE, &type);
+				glGetActiveUniformsiv(ID, 1, &index, GL_UNIFORM_SIZE, &member.size);
+				glGetActiveUniformsiv(ID, 1, &index, GL_UNIFORM_OFFSET, &member.offset);
+				glGetActiveUniformsiv(ID, 1, &index, GL_UNIFORM_ARRAY_STRIDE, &member.arrayStride);
+				glGetActiveUniformsiv(ID, 1, &index, GL_UNIFORM_MATRIX_STRIDE, &member.matrixStride);
+				member.type = (GLenum)type;
+				glGetActiveUniformName(ID, index, (GLsizei)nameBuf.size(), &len, nameBuf.data());
+				member.name.assign(nameBuf.data(), len);
+				if (member.name.empty() && spirvNames != nullptr) {
+					for (size_t n = 0; n < spirvNames->members.size(); n++) {
+						if (spirvNames->members[n].binding == block.binding && spirvNames->members[n].offset == member.offset) {
+							member.name = spirvNames->members[n].name;
+						}
+					}
+				}
+				if (member.name.compare(0, block.name.size() + 1, block.name + ".") == 0) {
+					member.name.erase(0, block.name.size() + 1);
+				}
+				size_t bracket = member.name.find("[0]");
+				if (bracket != std::string::npos && bracket + 3 == member.name.size()) {
+					member.name.erase(bracket);
+				}
+				member.hash = skHash32(member.name);
+				block.members.push_back(member);
+			}
+			blockList.push_back(block);
+		}
+	}
+	// Components per element and their base type (GL_FLOAT, GL_INT or GL_UNSIGNED_INT),
+	// matrices count all of their floats. 0 for types hot reload cannot carry over
+	static int uniformComponents(GLenum type, GLenum& base) {
+		base = GL_FLOAT;
+		switch (type) {
+		case GL_FLOAT: return 1;
+		case GL_FLOAT_VEC2: return 2;
+		case GL_FLOAT_VEC3: return 3;
+		case GL_FLOAT_VEC4: return 4;
+		case GL_FLOAT_MAT2: return 4;
+		case GL_FLOAT_MAT2x3: case GL_FLOAT_MAT3x2: return 6;
+		case GL_FLOAT_MAT2x4: case GL_FLOAT_MAT4x2: return 8;
+		case GL_FLOAT_MAT3: return 9;
+		case GL_FLOAT_MAT3x4: case GL_FLOAT_MAT4x3: return 12;
+		case GL_FLOAT_MAT4: return 16;
+		}
+		base = GL_UNSIGNED_INT;
+		switch (type) {
+		case GL_UNSIGNED_INT: return 1;
+		case GL_UNSIGNED_INT_VEC2: return 2;
+		case GL_UNSIGNED_INT_VEC3: return 3;
+		case GL_UNSIGNED_INT_VEC4: return 4;
+		}
+		base = GL_INT;
+		switch (type) {
+		case GL_INT_VEC2: case GL_BOOL_VEC2: return 2;
+		case GL_INT_VEC3: case GL_BOOL_VEC3: return 3;
+		case GL_INT_VEC4: case GL_BOOL_VEC4: return 4;
+		}
+		// int, bool and samplers are a single int
+		return UniformType<int>::accepts(type) ? 1 : 0;
+	}
+	// Copies every uniform both programs share (same name and type) from old into this one.
+	// A shared uniform of a type uniformComponents does not know is reported, it keeps its default
+	void copyUniformValues(const Shader& old) const {
+		for (size_t i = 0; i < old.uniformList.size(); i++) {
+			const UniformInfo& from = old.uniformList[i];
+			const UniformInfo* to = findUniform(from.hash);
+			if (to == nullptr || to->type != from.type) {
+				continue;
+			}
+			GLenum base;
+			int n = uniformComponents(from.type, base);
+			if (n == 0) {
+				std::cout << "ERROR::SHADER::UNIFORM_NOT_CARRIED_OVER\n" << from.name << " is GL type 0x" << std::hex << from.type << std::dec << std::endl;
+				continue;
+			}
+			GLint count = from.size < to->size ? from.size : to->size;
+			for (GLint e = 0; e < count; e++) {
+				GLint location = to->location + e;
+				if (base == GL_FLOAT) {
+					GLfloat v[16];
+					glGetUniformfv(old.ID, from.location + e, v);
+					switch (from.type) {
+					case GL_FLOAT: glProgramUniform1fv(ID, location, 1, v); break;
+					case GL_FLOAT_VEC2: glProgramUniform2fv(ID, location, 1, v); break;
+					case GL_FLOAT_VEC3: glProgramUniform3fv(ID, location, 1, v); break;
+					case GL_FLOAT_VEC4: glProgramUniform4fv(ID, location, 1, v); break;
+					case GL_FLOAT_MAT2: glProgramUniformMatrix2fv(ID, location, 1, GL_FALSE, v); break;
+					case GL_FLOAT_MAT2x3: glProgramUniformMatrix2x3fv(ID, location, 1, GL_FALSE, v); break;
+					case GL_FLOAT_MAT2x4: glProgramUniformMatrix2x4fv(ID, location, 1, GL_FALSE, v); break;
+					case GL_FLOAT_MAT3x2: glProgramUniformMatrix3x2fv(ID, location, 1, GL_FALSE, v); break;
+					case GL_FLOAT_MAT3: glProgramUniformMatrix3fv(ID, location, 1, GL_FALSE, v); break;
+					case GL_FLOAT_MAT3x4: glProgramUniformMatrix3x4fv(ID, location, 1, GL_FALSE, v); break;
+					case GL_FLOAT_MAT4x2: glProgramUniformMatrix4x2fv(ID, location, 1, GL_FALSE, v); break;
+					case GL_FLOAT_MAT4x3: glProgramUniformMatrix4x3fv(ID, location, 1, GL_FALSE, v); break;
+					case GL_FLOAT_MAT4: glProgramUniformMatrix4fv(ID, location, 1, GL_FALSE, v); break;
+					}
+				}
+				else if (base == GL_UNSIGNED_INT) {
+					GLuint v[4];
+					glGetUniformuiv(old.ID, from.location + e, v);
+					switch (n) {
+					case 1: glProgramUniform1uiv(ID, location, 1, v); break;
+					case 2: glProgramUniform2uiv(ID, location, 1, v); break;
+					case 3: glProgramUniform3uiv(ID, location, 1, v); break;
+					case 4: glProgramUniform4uiv(ID, location, 1, v); break;
+					}
+				}
+				else {
+					GLint v[4];
+					glGetUniformiv(old.ID, from.location + e, v);
+					switch (n) {
+					case 1: glProgramUniform1iv(ID, location, 1, v); break;
+					case 2: glProgramUniform2iv(ID, location, 1, v); break;
+					case 3: glProgramUniform3iv(ID, location, 1, v); break;
+					case 4: glProgramUniform4iv(ID, location, 1, v); break;
+					}
+				}
+			}
+		}
+	}
+	const UniformInfo* findUniform(uint32_t nameHash) const {
+		if (uniformTable.empty()) {
+			return nullptr;
+		}
+		size_t mask = uniformTable.size() - 1;
+		for (size_t slot = nameHash & mask; uniformTable[slot] >= 0; slot = (slot + 1) & mask) {
+			const UniformInfo& info = uniformList[uniformTable[slot]];
+			if (info.hash == nameHash) {
+				return &info;
+			}
+		}
+		return nullptr;
+	}
+};
+
+// Creates many programs at once. submit() queues every compile and link before any status
+// query, poll() finishes whichever programs the driver reports complete via
+// GL_COMPLETION_STATUS_KHR so each is usable as soon as it is ready. Without the
+// extension poll() finishes them in order and the driver's own threading does what it can
+class ShaderBatch {
+public:
+	size_t add(const char* vertexShaderPath, const char* fragmentShaderPath) {
+		entries.push_back(Entry());
+		entries.back().vertexPath = vertexShaderPath;
+		entries.back().fragmentPath = fragmentShaderPath;
+		return entries.size() - 1;
+	}
+	void submit() {
+		GLExt& ext = GLExt::get();
+		if (ext.maxShaderCompilerThreads != nullptr) {
+			// let the driver use as many compiler threads as it likes
+			ext.maxShaderCompilerThreads(0xFFFFFFFFu);
+		}
+		submitStart = std::chrono::steady_clock::now();
+		readyCount = 0;
+		failedCount = 0;
+		for (size_t i = 0; i < entries.size(); i++) {
+			std::string vertexShader, fragmentShader;
+			Shader::readSources(entries[i].vertexPath.c_str(), entries[i].fragmentPath.c_str(), vertexShader, fragmentShader);
+			entries[i].shader.beginCompile(vertexShader, fragmentShader);
+		}
+		poll();
+	}
+	// Finishes every program that is done, returns how many became ready in this call
+	size_t poll() {
+		size_t newlyReady = 0;
+		for (size_t i = 0; i < entries.size(); i++) {
+			Entry& e = entries[i];
+			if (e.ready || !e.shader.compileDone()) {
+				continue;
+			}
+			finishEntry(e);
+			newlyReady++;
+		}
+		return newlyReady;
+	}
+	// Blocks until every program is linked
+	void finish() {
+		for (size_t i = 0; i < entries.size(); i++) {
+			if (!entries[i].ready) {
+				finishEntry(entries[i]);
+			}
+		}
+	}
+	bool ready(size_t index) const {
+		return entries[index].ready;
+	}
+	bool done() const {
+		return readyCount == entries.size();
+	}
+	Shader& shader(size_t index) {
+		return entries[index].shader;
+	}
+	size_t size() const {
+		return entries.size();
+	}
+	void report() const {
+		std::cout << "SHADER::BATCH " << readyCount << "/" << entries.size() << " programs (" << failedCount
+			<< " failed) in " << totalMs << " ms, parallel compile "
+			<< (GLExt::get().parallelShaderCompile ? "on" : "off") << std::endl;
+	}
+private:
+	struct Entry {
+		std::string vertexPath;
+		std::string fragmentPath;
+		Shader shader;
+		bool ready = false;
+	};
+	std::vector<Entry> entries;
+	std::chrono::steady_clock::time_point submitStart;
+	size_t readyCount = 0;
+	size_t failedCount = 0;
+	double totalMs = 0.0;
+
+	void finishEntry(Entry& e) {
+		if (!e.shader.finishCompile()) {
+			failedCount++;
+		}
+		e.ready = true;
+		readyCount++;
+		totalMs = ProgramBinaryCache::elapsedMs(submitStart);
+	}
 };
 
 #endif // !SHADER_H
\ No newline at end of file
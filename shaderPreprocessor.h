@@ -0,0 +1,120 @@
+// Valor engine by Valores M.
+// GLSL preprocessing done before the driver sees the source: #include and injected #defines
+#ifndef SHADERPREPROCESSOR_H
+#define SHADERPREPROCESSOR_H
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// #include "file" (or <file>) is resolved relative to the including file. Each file is
+// pasted once per program like #pragma once, so shared block declarations can be
+// included from several places. #line directives keep driver errors pointing at the
+// right file: the source string number is the index into files
+class ShaderPreprocessor {
+public:
+	static bool expand(const std::string& path, std::string& out, std::vector<std::string>& files) {
+		out.clear();
+		files.clear();
+		return expandFile(path, out, files, 0);
+	}
+	// Adds "#define NAME 1" lines right after #version, then resets the line count
+	static std::string injectDefines(const std::string& source, const std::vector<std::string>& defines) {
+		if (defines.empty()) {
+			return source;
+		}
+		std::string block;
+		for (size_t i = 0; i < defines.size(); i++) {
+			block += "#define " + defines[i] + " 1\n";
+		}
+		size_t version = source.find("#version");
+		if (version == std::string::npos) {
+			return block + "#line 1 0\n" + source;
+		}
+		size_t lineEnd = source.find('\n', version);
+		if (lineEnd == std::string::npos) {
+			return source + "\n" + block;
+		}
+		// the #version line is line 1, whatever follows the defines is line 2
+		return source.substr(0, lineEnd + 1) + block + "#line 2 0\n" + source.substr(lineEnd + 1);
+	}
+private:
+	static const int maxDepth = 32;
+
+	static std::string directoryOf(const std::string& path) {
+		size_t slash = path.find_last_of("/\\");
+		return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+	}
+	static bool readFile(const std::string& path, std::string& out) {
+		std::ifstream file(path);
+		if (!file) {
+			return false;
+		}
+		std::stringstream stream;
+		stream << file.rdbuf();
+		out = stream.str();
+		return true;
+	}
+	// "#include" with optional leading whitespace, name between quotes or angle brackets
+	static bool parseInclude(const std::string& line, std::string& name) {
+		size_t p = line.find_first_not_of(" \t");
+		if (p == std::string::npos || line.compare(p, 8, "#include") != 0) {
+			return false;
+		}
+		size_t open = line.find_first_of("\"<", p + 8);
+		if (open == std::string::npos) {
+			return false;
+		}
+		size_t close = line.find(line[open] == '"' ? '"' : '>', open + 1);
+		if (close == std::string::npos) {
+			return false;
+		}
+		name = line.substr(open + 1, close - open - 1);
+		return true;
+	}
+	static bool expandFile(const std::string& path, std::string& out, std::vector<std::string>& files, int depth) {
+		for (size_t i = 0; i < files.size(); i++) {
+			if (files[i] == path) {
+				return true;
+			}
+		}
+		if (depth > maxDepth) {
+			std::cout << "ERROR::SHADER::PREPROCESSOR::INCLUDE_TOO_DEEP\n" << path << std::endl;
+			return false;
+		}
+		std::string source;
+		if (!readFile(path, source)) {
+			std::cout << "ERROR::SHADER::PREPROCESSOR::FILE_NOT_FOUND\n" << path << std::endl;
+			return false;
+		}
+		size_t fileIndex = files.size();
+		files.push_back(path);
+		if (depth > 0) {
+			out += "#line 1 " + std::to_string(fileIndex) + "\n";
+		}
+		std::istringstream lines(source);
+		std::string line, name;
+		int lineNumber = 0;
+		bool ok = true;
+		while (std::getline(lines, line)) {
+			lineNumber++;
+			if (parseInclude(line, name)) {
+				ok = expandFile(directoryOf(path) + name, out, files, depth + 1) && ok;
+				out += "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(fileIndex) + "\n";
+				continue;
+			}
+			// only the top file may declare the version
+			if (depth > 0 && line.find("#version") != std::string::npos) {
+				out += "\n";
+				continue;
+			}
+			out += line;
+			out += "\n";
+		}
+		return ok;
+	}
+};
+
+#endif // !SHADERPREPROCESSOR_H
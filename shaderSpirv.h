@@ -0,0 +1,208 @@
+// Valor engine by Valores M.
+// Precompiled SPIR-V stages (GL_ARB_gl_spirv): file lookup, staleness check and the bit of
+// reflection GL does not give us for SPIR-V programs
+#ifndef SHADERSPIRV_H
+#define SHADERSPIRV_H
+
+#include <sys/stat.h>
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Modules are built offline by shaders/Makefile: shaders/vertex.vs -> shaders/spirv/vertex.vs.spv.
+// A module older than any file its source reads (includes too) is ignored so edited GLSL
+// always wins until the step is rerun
+class ShaderSpirv {
+public:
+	// location -> name of one plain (non block) uniform, taken from OpName/OpDecorate
+	struct UniformName {
+		int location;
+		std::string name;
+	};
+	struct BlockName {
+		int binding;
+		std::string name;
+	};
+	// top level members only, nested struct members keep their empty GL names
+	struct BlockMemberName {
+		int binding;
+		int offset;
+		std::string name;
+	};
+	struct Names {
+		std::vector<UniformName> uniforms;
+		std::vector<BlockName> blocks;
+		std::vector<BlockMemberName> members;
+	};
+
+	static std::string binaryPath(const std::string& sourcePath) {
+		size_t slash = sourcePath.find_last_of("/\\");
+		std::string dir = slash == std::string::npos ? std::string() : sourcePath.substr(0, slash + 1);
+		return dir + "spirv/" + sourcePath.substr(dir.size()) + ".spv";
+	}
+	static bool upToDate(const std::string& binary, const std::vector<std::string>& sources) {
+		long long built = modifiedTime(binary);
+		if (built < 0) {
+			return false;
+		}
+		for (size_t i = 0; i < sources.size(); i++) {
+			if (modifiedTime(sources[i]) > built) {
+				return false;
+			}
+		}
+		return true;
+	}
+	// Reads a whole module and checks the header and that the instruction stream ends exactly
+	// at the end of the file. Drivers are not required to survive a malformed module
+	static bool load(const std::string& path, std::vector<uint32_t>& words) {
+		words.clear();
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (!file) {
+			return false;
+		}
+		std::streamoff bytes = file.tellg();
+		if (bytes < headerWords * 4 || bytes % 4 != 0) {
+			return false;
+		}
+		words.resize((size_t)bytes / 4);
+		file.seekg(0);
+		file.read((char*)words.data(), bytes);
+		if (!file.good() || words[0] != magic) {
+			return false;
+		}
+		size_t i = headerWords;
+		while (i < words.size()) {
+			uint32_t count = words[i] >> 16;
+			if (count == 0 || count > words.size() - i) {
+				return false;
+			}
+			i += count;
+		}
+		return true;
+	}
+	// Names survive in SPIR-V only as debug info, which GL is free to ignore. Without them
+	// glGetActiveUniform and friends return empty names, so they are recovered here: plain
+	// uniforms by location, uniform blocks by binding and block members by (binding, offset)
+	static void names(const std::vector<uint32_t>& words, Names& out) {
+		size_t bound = words.size() > 3 ? words[3] : 0;
+		std::vector<std::string> idNames(bound);
+		std::vector<int> locations(bound, -1);
+		std::vector<int> bindings(bound, -1);
+		std::vector<uint32_t> pointee(bound, 0);
+		std::vector<uint32_t> storage(bound, ~0u);
+		std::vector<uint32_t> varType(bound, 0);
+		// (struct id, member) pairs in declaration order
+		struct Member {
+			uint32_t type;
+			uint32_t index;
+			int offset;
+			std::string name;
+		};
+		std::vector<Member> members;
+		for (size_t i = headerWords; i < words.size();) {
+			uint32_t count = words[i] >> 16;
+			uint32_t op = words[i] & 0xFFFF;
+			if (count == 0 || i + count > words.size()) {
+				break;
+			}
+			const uint32_t* w = &words[i];
+			if (op == opName && count >= 3 && w[1] < bound) {
+				idNames[w[1]] = literalString(&w[2], count - 2);
+			}
+			else if (op == opMemberName && count >= 4) {
+				memberOf(members, w[1], w[2]).name = literalString(&w[3], count - 3);
+			}
+			else if (op == opDecorate && count >= 4 && w[1] < bound) {
+				if (w[2] == decorationLocation) {
+					locations[w[1]] = (int)w[3];
+				}
+				else if (w[2] == decorationBinding) {
+					bindings[w[1]] = (int)w[3];
+				}
+			}
+			else if (op == opMemberDecorate && count >= 5 && w[3] == decorationOffset) {
+				memberOf(members, w[1], w[2]).offset = (int)w[4];
+			}
+			else if (op == opTypePointer && count >= 4 && w[1] < bound) {
+				pointee[w[1]] = w[3];
+			}
+			else if (op == opVariable && count >= 4 && w[2] < bound) {
+				storage[w[2]] = w[3];
+				varType[w[2]] = w[1] < bound ? pointee[w[1]] : 0;
+			}
+			i += count;
+		}
+		for (size_t id = 0; id < bound; id++) {
+			if (storage[id] == storageUniformConstant && locations[id] >= 0 && !idNames[id].empty()) {
+				out.uniforms.push_back(UniformName{ locations[id], idNames[id] });
+			}
+			if (storage[id] != storageUniform || bindings[id] < 0) {
+				continue;
+			}
+			// the block name is the struct type name, the variable is the instance name
+			uint32_t block = varType[id];
+			if (block < bound && !idNames[block].empty()) {
+				out.blocks.push_back(BlockName{ bindings[id], idNames[block] });
+			}
+			for (size_t m = 0; m < members.size(); m++) {
+				if (members[m].type == block && members[m].offset >= 0 && !members[m].name.empty()) {
+					out.members.push_back(BlockMemberName{ bindings[id], members[m].offset, members[m].name });
+				}
+			}
+		}
+	}
+private:
+	static const uint32_t magic = 0x07230203;
+	static const int headerWords = 5;
+	static const uint32_t opName = 5;
+	static const uint32_t opMemberName = 6;
+	static const uint32_t opTypePointer = 32;
+	static const uint32_t opVariable = 59;
+	static const uint32_t opDecorate = 71;
+	static const uint32_t opMemberDecorate = 72;
+	static const uint32_t decorationLocation = 30;
+	static const uint32_t decorationBinding = 33;
+	static const uint32_t decorationOffset = 35;
+	static const uint32_t storageUniformConstant = 0;
+	static const uint32_t storageUniform = 2;
+
+	static long long modifiedTime(const std::string& path) {
+		struct stat info;
+		if (stat(path.c_str(), &info) != 0) {
+			return -1;
+		}
+		return (long long)info.st_mtime;
+	}
+	template<class Member>
+	static Member& memberOf(std::vector<Member>& members, uint32_t type, uint32_t index) {
+		for (size_t i = 0; i < members.size(); i++) {
+			if (members[i].type == type && members[i].index == index) {
+				return members[i];
+			}
+		}
+		Member m;
+		m.type = type;
+		m.index = index;
+		m.offset = -1;
+		members.push_back(m);
+		return members.back();
+	}
+	// nul terminated UTF-8 packed little end first into words
+	static std::string literalString(const uint32_t* w, uint32_t count) {
+		std::string s;
+		for (uint32_t i = 0; i < count; i++) {
+			for (int b = 0; b < 4; b++) {
+				char c = (char)((w[i] >> (8 * b)) & 0xFF);
+				if (c == 0) {
+					return s;
+				}
+				s += c;
+			}
+		}
+		return s;
+	}
+};
+
+#endif // !SHADERSPIRV_H
@@ -0,0 +1,88 @@
+// Valor engine by Valores M.
+// Lazily compiled shader permutations selected by a feature bitmask
+#ifndef SHADERVARIANTS_H
+#define SHADERVARIANTS_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "shader.h"
+
+// features[i] is the #define injected when bit i of the mask is set. Nothing compiles up
+// front: get(mask) builds a permutation the first time it is asked for, keyed by the mask
+// plus a hash of the expanded sources, and every later call returns the same program.
+// Bits past the last feature select nothing and are dropped before the lookup
+class ShaderVariants {
+public:
+	ShaderVariants(const char* vertexShaderPath, const char* fragmentShaderPath, const std::vector<std::string>& featureDefines)
+		: vertexPath(vertexShaderPath), fragmentPath(fragmentShaderPath), features(featureDefines) {
+		reload();
+	}
+	Shader& get(uint32_t featureMask) {
+		featureMask &= features.size() >= 32 ? ~0u : (1u << features.size()) - 1;
+		uint64_t key = skHash64(&featureMask, sizeof(featureMask), sourceHash);
+		std::unordered_map<uint64_t, Shader>::iterator it = variants.find(key);
+		if (it != variants.end()) {
+			hits++;
+			return it->second;
+		}
+		std::vector<std::string> defines;
+		for (size_t i = 0; i < features.size() && i < 32; i++) {
+			if (featureMask & (1u << i)) {
+				defines.push_back(features[i]);
+			}
+		}
+		Shader& shader = variants[key];
+		shader.beginCompile(ShaderPreprocessor::injectDefines(vertexBase, defines), ShaderPreprocessor::injectDefines(fragmentBase, defines));
+		shader.finishCompile();
+		return shader;
+	}
+	// Mask with the bit for each named feature set, unknown names are reported and ignored
+	uint32_t mask(const std::vector<std::string>& enabled) const {
+		uint32_t m = 0;
+		for (size_t e = 0; e < enabled.size(); e++) {
+			size_t i = 0;
+			while (i < features.size() && features[i] != enabled[e]) {
+				i++;
+			}
+			if (i == features.size()) {
+				std::cout << "ERROR::SHADER::VARIANT::UNKNOWN_FEATURE\n" << enabled[e] << std::endl;
+				continue;
+			}
+			m |= 1u << i;
+		}
+		return m;
+	}
+	// Re-reads the sources. Variants of older sources stay valid until released, new
+	// requests compile against the new text
+	bool reload() {
+		bool ok = Shader::readSources(vertexPath.c_str(), fragmentPath.c_str(), vertexBase, fragmentBase);
+		uint64_t sizes[2] = { vertexBase.size(), fragmentBase.size() };
+		sourceHash = skHash64(fragmentBase, skHash64(vertexBase, skHash64(sizes, sizeof(sizes))));
+		return ok;
+	}
+	void release() {
+		for (std::unordered_map<uint64_t, Shader>::iterator it = variants.begin(); it != variants.end(); ++it) {
+			glDeleteProgram(it->second.ID);
+		}
+		variants.clear();
+	}
+	size_t compiledCount() const {
+		return variants.size();
+	}
+	size_t hitCount() const {
+		return hits;
+	}
+private:
+	std::string vertexPath;
+	std::string fragmentPath;
+	std::vector<std::string> features;
+	std::string vertexBase;
+	std::string fragmentBase;
+	uint64_t sourceHash = 0;
+	std::unordered_map<uint64_t, Shader> variants;
+	size_t hits = 0;
+};
+
+#endif // !SHADERVARIANTS_H
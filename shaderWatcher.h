@@ -0,0 +1,197 @@
+// Valor engine by Valores M.
+// Shader hot reload: watch source files (inotify on Linux) and swap in the relinked program
+#ifndef SHADERWATCHER_H
+#define SHADERWATCHER_H
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "shader.h"
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#define SK_HAS_INOTIFY 1
+#endif
+
+// Call poll() once per frame on the GL thread. A changed file queues a recompile of every
+// program using it; the old program keeps rendering until the new one links, then
+// Shader::adoptProgram swaps the ID between frames with the uniform values carried over.
+// A failed compile logs the error and keeps the old program. Without inotify this is a no-op
+class ShaderWatcher {
+public:
+	ShaderWatcher() {
+#ifdef SK_HAS_INOTIFY
+		fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (fd < 0) {
+			std::cout << "ERROR::SHADER::WATCHER::INOTIFY_INIT_FAILED" << std::endl;
+		}
+#endif
+	}
+	~ShaderWatcher() {
+#ifdef SK_HAS_INOTIFY
+		if (fd >= 0) {
+			close(fd);
+		}
+#endif
+	}
+	ShaderWatcher(const ShaderWatcher&) = delete;
+	ShaderWatcher& operator=(const ShaderWatcher&) = delete;
+
+	// shader must outlive the watcher
+	void watch(Shader& shader, const char* vertexShaderPath, const char* fragmentShaderPath) {
+		Watched w;
+		w.shader = &shader;
+		w.vertexPath = vertexShaderPath;
+		w.fragmentPath = fragmentShaderPath;
+		std::string vertexShader, fragmentShader;
+		Shader::readSources(vertexShaderPath, fragmentShaderPath, vertexShader, fragmentShader, &w.files);
+		watched.push_back(w);
+		watchFiles(watched.back());
+	}
+	// Returns how many programs were swapped during this call
+	size_t poll() {
+		readEvents();
+		size_t swapped = 0;
+		for (size_t i = 0; i < watched.size(); i++) {
+			Watched& w = watched[i];
+			if (w.dirty && !w.compiling) {
+				startReload(w);
+			}
+			if (!w.compiling || !w.fresh.compileDone()) {
+				continue;
+			}
+			w.compiling = false;
+			bool linked = w.fresh.finishCompile();
+			// edited again while compiling: drop this result, the next poll starts over
+			if (w.dirty) {
+				glDeleteProgram(w.fresh.ID);
+				continue;
+			}
+			double ms = ProgramBinaryCache::elapsedMs(w.changedAt);
+			if (!linked) {
+				glDeleteProgram(w.fresh.ID);
+				std::cout << "ERROR::SHADER::RELOAD_FAILED\n" << w.vertexPath << " + " << w.fragmentPath << ", keeping program " << w.shader->ID << std::endl;
+				continue;
+			}
+			w.shader->adoptProgram(w.fresh);
+			swapped++;
+			std::cout << "SHADER::RELOAD " << w.vertexPath << " + " << w.fragmentPath << " -> program " << w.shader->ID << " in " << ms << " ms" << std::endl;
+		}
+		return swapped;
+	}
+private:
+	struct Watched {
+		Shader* shader = nullptr;
+		std::string vertexPath;
+		std::string fragmentPath;
+		// stage files plus everything they #include
+		std::vector<std::string> files;
+		// replacement being compiled
+		Shader fresh;
+		bool dirty = false;
+		bool compiling = false;
+		std::chrono::steady_clock::time_point changedAt;
+	};
+	struct Directory {
+		int wd = -1;
+		std::string path;
+	};
+	std::vector<Watched> watched;
+	std::vector<Directory> directories;
+	int fd = -1;
+
+	static std::string directoryOf(const std::string& path) {
+		size_t slash = path.find_last_of("/\\");
+		return slash == std::string::npos ? std::string(".") : path.substr(0, slash);
+	}
+	static std::string fileOf(const std::string& path) {
+		size_t slash = path.find_last_of("/\\");
+		return slash == std::string::npos ? path : path.substr(slash + 1);
+	}
+	void watchFiles(const Watched& w) {
+		watchDirectory(w.vertexPath);
+		watchDirectory(w.fragmentPath);
+		for (size_t i = 0; i < w.files.size(); i++) {
+			watchDirectory(w.files[i]);
+		}
+	}
+	void watchDirectory(const std::string& file) {
+#ifdef SK_HAS_INOTIFY
+		if (fd < 0) {
+			return;
+		}
+		std::string dir = directoryOf(file);
+		for (size_t i = 0; i < directories.size(); i++) {
+			if (directories[i].path == dir) {
+				return;
+			}
+		}
+		// editors often save through a temp file and rename, so MOVED_TO matters as much as CLOSE_WRITE
+		int wd = inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+		if (wd < 0) {
+			std::cout << "ERROR::SHADER::WATCHER::ADD_WATCH_FAILED\n" << dir << std::endl;
+			return;
+		}
+		Directory d;
+		d.wd = wd;
+		d.path = dir;
+		directories.push_back(d);
+#endif
+	}
+	void fileChanged(const std::string& dir, const std::string& name) {
+		for (size_t i = 0; i < watched.size(); i++) {
+			Watched& w = watched[i];
+			bool hit = (directoryOf(w.vertexPath) == dir && fileOf(w.vertexPath) == name)
+				|| (directoryOf(w.fragmentPath) == dir && fileOf(w.fragmentPath) == name);
+			for (size_t f = 0; f < w.files.size() && !hit; f++) {
+				hit = directoryOf(w.files[f]) == dir && fileOf(w.files[f]) == name;
+			}
+			if (hit) {
+				w.dirty = true;
+				w.changedAt = std::chrono::steady_clock::now();
+			}
+		}
+	}
+	void readEvents() {
+#ifdef SK_HAS_INOTIFY
+		if (fd < 0) {
+			return;
+		}
+		alignas(struct inotify_event) char buf[4096];
+		for (;;) {
+			ssize_t len = read(fd, buf, sizeof(buf));
+			if (len <= 0) {
+				break;
+			}
+			for (char* p = buf; p < buf + len; ) {
+				const struct inotify_event* ev = (const struct inotify_event*)p;
+				if (ev->len > 0) {
+					for (size_t i = 0; i < directories.size(); i++) {
+						if (directories[i].wd == ev->wd) {
+							fileChanged(directories[i].path, ev->name);
+						}
+					}
+				}
+				p += sizeof(struct inotify_event) + ev->len;
+			}
+		}
+#endif
+	}
+	void startReload(Watched& w) {
+		w.dirty = false;
+		std::string vertexShader, fragmentShader;
+		if (!Shader::readSources(w.vertexPath.c_str(), w.fragmentPath.c_str(), vertexShader, fragmentShader, &w.files)) {
+			return;
+		}
+		// the edit may have added includes
+		watchFiles(w);
+		w.fresh = Shader();
+		w.fresh.beginCompile(vertexShader, fragmentShader);
+		w.compiling = true;
+	}
+};
+
+#endif // !SHADERWATCHER_H
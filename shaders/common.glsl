@@ -0,0 +1,24 @@
+// Blocks shared by every program, filled once per frame (uniformBuffers.h). The bindings
+// repeat UniformBinding because SPIR-V programs cannot be bound by block name
+layout (std140, binding = 0) uniform FrameData {
+    float time;
+    float deltaTime;
+    vec2 resolution;
+};
+
+layout (std140, binding = 1) uniform ViewData {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProj;
+    vec4 camPos;
+};
+
+// One record per draw, written by DrawDataBuffer (drawData.h) and indexed by the base instance
+struct DrawData {
+    mat4 model;
+    uint material;
+};
+
+layout (std430, binding = 0) readonly buffer DrawBuffer {
+    DrawData draws[];
+};
\ No newline at end of file
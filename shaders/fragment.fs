@@ -1,12 +1,18 @@
 #version 430 core
-out vec4 FragColor;
+layout (location = 0) out vec4 FragColor;
 
-in vec2 TexCoord;
+layout (location = 0) in vec2 TexCoord;
 
-uniform sampler2D texture1;
-uniform sampler2D texture2;
+layout (binding = 0, location = 1) uniform sampler2D texture1;
+layout (binding = 1, location = 2) uniform sampler2D texture2;
+
+// per material parameters, packed and bound by MaterialLibrary (material.h)
+layout (std140, binding = 2) uniform MaterialData {
+    vec4 tint;
+    float mixAmount;
+};
 
 void main()
 {
-    FragColor = mix(texture(texture1, TexCoord), texture(texture2, TexCoord), 0.2);
+    FragColor = mix(texture(texture1, TexCoord), texture(texture2, TexCoord), mixAmount) * tint;
 }
\ No newline at end of file
@@ -1,15 +1,21 @@
 #version 430 core
+#extension GL_ARB_shader_draw_parameters : enable
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec2 aTexCoord;
+// 0, 1, 2... with divisor 1, equals baseInstance + gl_InstanceID without the extension
+layout (location = 2) in uint aDrawIndex;
 
-out vec2 TexCoord;
+layout (location = 0) out vec2 TexCoord;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+#include "common.glsl"
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(aPos, 1.0f);
+#ifdef GL_ARB_shader_draw_parameters
+    uint drawIndex = uint(gl_BaseInstanceARB + gl_InstanceID);
+#else
+    uint drawIndex = aDrawIndex;
+#endif
+    gl_Position = viewProj * draws[drawIndex].model * vec4(aPos, 1.0f);
     TexCoord = vec2(aTexCoord.x, aTexCoord.y);
 }
\ No newline at end of file
@@ -0,0 +1,44 @@
+// Valor engine by Valores M.
+// FNV-1a hashing. skHash32 is constexpr so uniform and block names can be hashed at compile time
+#ifndef SKHASH_H
+#define SKHASH_H
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+constexpr uint32_t skHash32(const char* str, size_t len) {
+	uint32_t h = 2166136261u;
+	for (size_t i = 0; i < len; i++) {
+		h = (h ^ (uint32_t)(unsigned char)str[i]) * 16777619u;
+	}
+	return h;
+}
+constexpr uint32_t skHash32(const char* str) {
+	uint32_t h = 2166136261u;
+	for (; *str; str++) {
+		h = (h ^ (uint32_t)(unsigned char)*str) * 16777619u;
+	}
+	return h;
+}
+inline uint32_t skHash32(const std::string& str) {
+	return skHash32(str.c_str(), str.size());
+}
+
+// 64-bit variant for content keys (sources, binaries), chain calls through seed
+inline uint64_t skHash64(const void* data, size_t len, uint64_t seed = 14695981039346656037ull) {
+	const unsigned char* p = static_cast<const unsigned char*>(data);
+	uint64_t h = seed;
+	for (size_t i = 0; i < len; i++) {
+		h = (h ^ p[i]) * 1099511628211ull;
+	}
+	return h;
+}
+inline uint64_t skHash64(const std::string& str, uint64_t seed = 14695981039346656037ull) {
+	return skHash64(str.data(), str.size(), seed);
+}
+
+// Forces compile-time evaluation: SK_HASH("model") is an integral constant
+#define SK_HASH(str) (std::integral_constant<uint32_t, skHash32(str)>::value)
+
+#endif // !SKHASH_H
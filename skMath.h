@@ -2,74 +2,212 @@
 // Written to handle GL Mathematics
 #ifndef SKMATH_H
 #define SKMATH_H
-#include <vector>
+#include <cstring>
+#include <cmath>
+#include "skSimd.h"
 
-float PI = 3.14159265f;
+constexpr float PI = 3.14159265f;
+
+// Compile-time capable sin/cos/tan/sqrt in double precision so constexpr transforms and
+// projections get baked at build time. Slower than <cmath> when called at runtime
+struct skConstMath {
+	static constexpr double pi = 3.14159265358979323846;
+	// wrap to [-pi, pi] so the series converge quickly
+	static constexpr double wrap(double x) {
+		double turns = x / (2.0 * pi);
+		long long n = (long long)(turns < 0.0 ? turns - 0.5 : turns + 0.5);
+		return x - (double)n * 2.0 * pi;
+	}
+	static constexpr double sin(double x) {
+		x = wrap(x);
+		double term = x, sum = x;
+		for (int i = 1; i < 12; i++) {
+			term *= -x * x / ((2.0 * i) * (2.0 * i + 1.0));
+			sum += term;
+		}
+		return sum;
+	}
+	static constexpr double cos(double x) {
+		x = wrap(x);
+		double term = 1.0, sum = 1.0;
+		for (int i = 1; i < 12; i++) {
+			term *= -x * x / ((2.0 * i - 1.0) * (2.0 * i));
+			sum += term;
+		}
+		return sum;
+	}
+	static constexpr double tan(double x) {
+		return sin(x) / cos(x);
+	}
+	static constexpr double sqrt(double x) {
+		if (x <= 0.0) {
+			return 0.0;
+		}
+		double r = x > 1.0 ? x : 1.0;
+		for (int i = 0; i < 64; i++) {
+			double next = 0.5 * (r + x / r);
+			if (next == r) {
+				break;
+			}
+			r = next;
+		}
+		return r;
+	}
+};
+
+// Pick per call site: skMathFn<SK_PRECISE> is <cmath>, skMathFn<SK_FAST> trades a bounded
+// error for speed. Bounds measured over the float range each function documents
+enum skAccuracy {
+	SK_PRECISE,
+	SK_FAST
+};
+template<skAccuracy A>
+struct skMathFn;
+
+template<>
+struct skMathFn<SK_PRECISE> {
+	static float rsqrt(float x) {
+		return 1.0f / std::sqrt(x);
+	}
+	static void sincos(float x, float* s, float* c) {
+		*s = std::sin(x);
+		*c = std::cos(x);
+	}
+	static float atan2(float y, float x) {
+		return std::atan2(y, x);
+	}
+	static void sincosBatch(const float* angle, float* s, float* c, size_t count) {
+		for (size_t i = 0; i < count; i++) {
+			sincos(angle[i], s + i, c + i);
+		}
+	}
+	// SoA vectors normalized in place, zero length stays zero. sqrt and divide, every
+	// component within 3e-7 of the exact unit vector
+	static void normalizeBatch(float* x, float* y, float* z, size_t count) {
+		skKernels::active().normalize3Batch(x, y, z, count);
+	}
+};
+
+template<>
+struct skMathFn<SK_FAST> {
+	// rsqrtss plus one Newton step, relative error under 5e-7 (about 4 ulp)
+	static float rsqrt(float x) {
+#if defined(SK_SIMD_X86) && (defined(_MSC_VER) || defined(__SSE__))
+		float r = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x)));
+		return r * (1.5f - 0.5f * x * r * r);
+#else
+		return 1.0f / std::sqrt(x);
+#endif
+	}
+	// Cephes polynomial, one range reduction for both results. Within 2 ulp of sin/cos away
+	// from their zeros (absolute error under 1e-7 everywhere) for |x| < 8192
+	static void sincos(float x, float* s, float* c) {
+		skScalarKernels::sincos(x, s, c);
+	}
+	// Abramowitz & Stegun 4.4.49 odd polynomial, absolute error under 1.2e-5 rad
+	static float atan2(float y, float x) {
+		float ax = std::fabs(x), ay = std::fabs(y);
+		float mx = ax > ay ? ax : ay;
+		float mn = ax > ay ? ay : ax;
+		if (mx == 0.0f) {
+			return 0.0f;
+		}
+		float a = mn / mx;
+		float a2 = a * a;
+		float r = a * (0.9998660f + a2 * (-0.3302995f + a2 * (0.1801410f + a2 * (-0.0851330f + a2 * 0.0208351f))));
+		if (ay > ax) {
+			r = 1.57079637f - r;
+		}
+		if (x < 0.0f) {
+			r = 3.14159274f - r;
+		}
+		return y < 0.0f ? -r : r;
+	}
+	// SIMD sincos, same bounds as sincos
+	static void sincosBatch(const float* angle, float* s, float* c, size_t count) {
+		skKernels::active().sincosBatch(angle, s, c, count);
+	}
+	// rsqrt plus Newton, relative error under 5e-7
+	static void normalizeBatch(float* x, float* y, float* z, size_t count) {
+		skKernels::active().normalize3FastBatch(x, y, z, count);
+	}
+};
 
 template<class skMath>
 struct Vect3 {
 	skMath x, y, z;
-	Vect3(skMath x, skMath y, skMath z) : x(x), y(y), z(z) {}
-	Vect3() {}
-	Vect3<skMath>& operator=(Vect3<skMath> other) {
-		this->x = other.x;
-		this->y = other.y;
-		this->z = other.z;
-		return *this;
-	};
+	constexpr Vect3(skMath x, skMath y, skMath z) : x(x), y(y), z(z) {}
+	constexpr Vect3() : x(0), y(0), z(0) {}
+	constexpr Vect3<skMath> operator+(const Vect3<skMath>& other) const {
+		return Vect3<skMath>(x + other.x, y + other.y, z + other.z);
+	}
+	constexpr Vect3<skMath> operator-(const Vect3<skMath>& other) const {
+		return Vect3<skMath>(x - other.x, y - other.y, z - other.z);
+	}
+	constexpr Vect3<skMath> operator*(skMath s) const {
+		return Vect3<skMath>(x * s, y * s, z * s);
+	}
+	static constexpr skMath dot(const Vect3<skMath>& a, const Vect3<skMath>& b) {
+		return a.x * b.x + a.y * b.y + a.z * b.z;
+	}
+	static constexpr Vect3<skMath> cross(const Vect3<skMath>& a, const Vect3<skMath>& b) {
+		return Vect3<skMath>(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+	}
 	static float lengthVect(Vect3<skMath> vect) {
-		skMath length = sqrt((vect.x * vect.x) + (vect.y * vect.y) + (vect.z * vect.z));
+		skMath length = std::sqrt((vect.x * vect.x) + (vect.y * vect.y) + (vect.z * vect.z));
 		return length;
 	};
+	template<skAccuracy A = SK_PRECISE>
+	static Vect3<skMath> normalizeVect(Vect3<skMath> vect) {
+		skMath len2 = dot(vect, vect);
+		if (len2 <= 0) {
+			return vect;
+		}
+		return vect * (skMath)skMathFn<A>::rsqrt((float)len2);
+	}
 };
 template<class skMath>
 struct Vect4 {
 	skMath x, y, z, w;
-	Vect4(skMath x, skMath y, skMath z, skMath w): x(x), y(y), z(z), w(w){}
-	Vect4() {}
-	Vect4<skMath>& operator=(Vect4<skMath> other) {
-		this->x = other.x;
-		this->y = other.y;
-		this->z = other.z;
-		this->w = other.w;
-		return *this;
+	constexpr Vect4(skMath x, skMath y, skMath z, skMath w): x(x), y(y), z(z), w(w){}
+	constexpr Vect4() : x(0), y(0), z(0), w(0) {}
+	constexpr Vect4<skMath> operator+(const Vect4<skMath>& other) const {
+		return Vect4<skMath>(x + other.x, y + other.y, z + other.z, w + other.w);
+	}
+	constexpr Vect4<skMath> operator*(skMath s) const {
+		return Vect4<skMath>(x * s, y * s, z * s, w * s);
 	}
 };
+// Storage is 16 contiguous, 16-byte aligned values in GL column-major order: row1..row4
+// hold the four columns (perspective already builds them that way), so data() can go
+// straight to glUniformMatrix4fv(..., GL_FALSE, ...) or be memcpy'd into a buffer.
+// multMat4(a, b) applies a first then b, i.e. b * a in column-vector notation.
+// The constexpr operators use column-vector notation like glm: a * b applies b first.
 template<class skMath>
-struct Mat4x4 {
+struct alignas(16) Mat4x4 {
 	Vect4<skMath> row1, row2, row3, row4;
-	Mat4x4() {
-		row1 = Vect4<skMath>(1.0f, 0.0f, 0.0f, 0.0f);
-		row2 = Vect4<skMath>(0.0f, 1.0f, 0.0f, 0.0f);
-		row3 = Vect4<skMath>(0.0f, 0.0f, 1.0f, 0.0f);
-		row4 = Vect4<skMath>(0.0f, 0.0f, 0.0f, 1.0f);
-	}
-	Mat4x4(const Mat4x4<skMath>& other) {
-		this->row1 = other.row1;
-		this->row2 = other.row2;
-		this->row3 = other.row3;
-		this->row4 = other.row4;
-	}
-	static Mat4x4<skMath> identityMatrix() {
+	constexpr Mat4x4()
+		: row1(1.0f, 0.0f, 0.0f, 0.0f),
+		  row2(0.0f, 1.0f, 0.0f, 0.0f),
+		  row3(0.0f, 0.0f, 1.0f, 0.0f),
+		  row4(0.0f, 0.0f, 0.0f, 1.0f) {}
+	static constexpr Mat4x4<skMath> identityMatrix() {
 		return Mat4x4<skMath>(
 			Vect4<skMath>(1.0f, 0.0f, 0.0f, 0.0f),
 			Vect4<skMath>(0.0f, 1.0f, 0.0f, 0.0f),
 			Vect4<skMath>(0.0f, 0.0f, 1.0f, 0.0f),
 			Vect4<skMath>(0.0f, 0.0f, 0.0f, 1.0f));
 	}
-	Mat4x4(Vect4<skMath> r1, Vect4<skMath> r2, Vect4<skMath> r3, Vect4<skMath> r4) {
-		this->row1 = r1;
-		this->row2 = r2;
-		this->row3 = r3;
-		this->row4 = r4;
-	}
-	static skMath toRad(GLfloat angle) {
+	constexpr Mat4x4(Vect4<skMath> r1, Vect4<skMath> r2, Vect4<skMath> r3, Vect4<skMath> r4)
+		: row1(r1), row2(r2), row3(r3), row4(r4) {}
+	static constexpr skMath toRad(GLfloat angle) {
 		return angle * (PI / 180.0f);
 	}
-	static Mat4x4<skMath> perspective(GLfloat FoV, GLfloat aspectR, GLfloat near, GLfloat far) {
+	// FoV is the full vertical angle in degrees, like glm::perspective
+	static constexpr Mat4x4<skMath> perspective(GLfloat FoV, GLfloat aspectR, GLfloat near, GLfloat far) {
 		skMath fn = far + near;
 		skMath f_n = far - near;
-		skMath t = 1.0f / (tan(toRad(FoV))) / 2.0f;
+		skMath t = (skMath)(1.0 / skConstMath::tan(toRad(FoV) / 2.0));
 
 		return Mat4x4<skMath>(
 			Vect4<skMath>(t / aspectR, 0.0f, 0.0f, 0.0f),
@@ -77,6 +215,66 @@ struct Mat4x4 {
 			Vect4<skMath>(0.0f, 0.0f, -fn / f_n, -1.0f),
 			Vect4<skMath>(0.0f, 0.0f, -2.0f * far * near / f_n, 0.0f));
 	}
+	constexpr Mat4x4<skMath> operator+(const Mat4x4<skMath>& other) const {
+		return Mat4x4<skMath>(row1 + other.row1, row2 + other.row2, row3 + other.row3, row4 + other.row4);
+	}
+	constexpr Vect4<skMath> operator*(const Vect4<skMath>& vect) const {
+		return row1 * vect.x + row2 * vect.y + row3 * vect.z + row4 * vect.w;
+	}
+	constexpr Mat4x4<skMath> operator*(const Mat4x4<skMath>& other) const {
+		return Mat4x4<skMath>(*this * other.row1, *this * other.row2, *this * other.row3, *this * other.row4);
+	}
+	static constexpr Mat4x4<skMath> transpose(const Mat4x4<skMath>& mat1) {
+		return Mat4x4<skMath>(
+			Vect4<skMath>(mat1.row1.x, mat1.row2.x, mat1.row3.x, mat1.row4.x),
+			Vect4<skMath>(mat1.row1.y, mat1.row2.y, mat1.row3.y, mat1.row4.y),
+			Vect4<skMath>(mat1.row1.z, mat1.row2.z, mat1.row3.z, mat1.row4.z),
+			Vect4<skMath>(mat1.row1.w, mat1.row2.w, mat1.row3.w, mat1.row4.w));
+	}
+	static constexpr Mat4x4<skMath> translation(Vect3<skMath> t) {
+		return Mat4x4<skMath>(
+			Vect4<skMath>(1.0f, 0.0f, 0.0f, 0.0f),
+			Vect4<skMath>(0.0f, 1.0f, 0.0f, 0.0f),
+			Vect4<skMath>(0.0f, 0.0f, 1.0f, 0.0f),
+			Vect4<skMath>(t.x, t.y, t.z, 1.0f));
+	}
+	static constexpr Mat4x4<skMath> scaling(Vect3<skMath> s) {
+		return Mat4x4<skMath>(
+			Vect4<skMath>(s.x, 0.0f, 0.0f, 0.0f),
+			Vect4<skMath>(0.0f, s.y, 0.0f, 0.0f),
+			Vect4<skMath>(0.0f, 0.0f, s.z, 0.0f),
+			Vect4<skMath>(0.0f, 0.0f, 0.0f, 1.0f));
+	}
+	// radians, axis normalized here
+	static constexpr Mat4x4<skMath> rotation(Vect3<skMath> axis, skMath angle) {
+		skMath inv = (skMath)(1.0 / skConstMath::sqrt(Vect3<skMath>::dot(axis, axis)));
+		skMath x = axis.x * inv, y = axis.y * inv, z = axis.z * inv;
+		skMath c = (skMath)skConstMath::cos(angle);
+		skMath s = (skMath)skConstMath::sin(angle);
+		skMath t = 1 - c;
+		return Mat4x4<skMath>(
+			Vect4<skMath>(t * x * x + c, t * x * y + s * z, t * x * z - s * y, 0),
+			Vect4<skMath>(t * x * y - s * z, t * y * y + c, t * y * z + s * x, 0),
+			Vect4<skMath>(t * x * z + s * y, t * y * z - s * x, t * z * z + c, 0),
+			Vect4<skMath>(0, 0, 0, 1));
+	}
+	// translation * rotation * scale, the usual static model matrix
+	static constexpr Mat4x4<skMath> trs(Vect3<skMath> pos, Vect3<skMath> axis, skMath angle, Vect3<skMath> scale) {
+		return translation(pos) * rotation(axis, angle) * scaling(scale);
+	}
+	// Rigid view matrix looking from eye towards center, same result as glm::lookAt
+	static constexpr Mat4x4<skMath> lookAt(Vect3<skMath> eye, Vect3<skMath> center, Vect3<skMath> up) {
+		Vect3<skMath> f = center - eye;
+		f = f * (skMath)(1.0 / skConstMath::sqrt(Vect3<skMath>::dot(f, f)));
+		Vect3<skMath> s = Vect3<skMath>::cross(f, up);
+		s = s * (skMath)(1.0 / skConstMath::sqrt(Vect3<skMath>::dot(s, s)));
+		Vect3<skMath> u = Vect3<skMath>::cross(s, f);
+		return Mat4x4<skMath>(
+			Vect4<skMath>(s.x, u.x, -f.x, 0.0f),
+			Vect4<skMath>(s.y, u.y, -f.y, 0.0f),
+			Vect4<skMath>(s.z, u.z, -f.z, 0.0f),
+			Vect4<skMath>(-Vect3<skMath>::dot(s, eye), -Vect3<skMath>::dot(u, eye), Vect3<skMath>::dot(f, eye), 1.0f));
+	}
 	static Mat4x4<skMath> addMat4(Mat4x4<skMath> mat1, Mat4x4<skMath> mat2) {
 		Mat4x4<skMath> addedMat;
 		addedMat.row1 = Vect4<skMath>(mat1.row1.x + mat2.row1.x, mat1.row1.y + mat2.row1.y, mat1.row1.z + mat2.row1.z, mat1.row1.w + mat2.row1.w);
@@ -106,86 +304,269 @@ struct Mat4x4 {
 
 		return result;
 	}
-	static Mat4x4<skMath> scalingMat4(Mat4x4<skMath>& mat1, Vect4<skMath> scaleVec) {
-		Mat4x4<skMath> tmp(mat1);
-		tmp.row1.x *= scaleVec.x;
-		tmp.row2.y *= scaleVec.y;
-		tmp.row3.z *= scaleVec.z;
-		return tmp;
+	// Row vector times matrix, same convention as multMat4
+	static Vect4<skMath> multVect4(const Mat4x4<skMath>& mat1, Vect4<skMath> vect) {
+		return Vect4<skMath>(
+			vect.x * mat1.row1.x + vect.y * mat1.row2.x + vect.z * mat1.row3.x + vect.w * mat1.row4.x,
+			vect.x * mat1.row1.y + vect.y * mat1.row2.y + vect.z * mat1.row3.y + vect.w * mat1.row4.y,
+			vect.x * mat1.row1.z + vect.y * mat1.row2.z + vect.z * mat1.row3.z + vect.w * mat1.row4.z,
+			vect.x * mat1.row1.w + vect.y * mat1.row2.w + vect.z * mat1.row3.w + vect.w * mat1.row4.w);
+	}
+	// out[i] = multMat4(mat1[i], mat2[i]), out may alias either input
+	static void multMat4Batch(const Mat4x4<skMath>* mat1, const Mat4x4<skMath>* mat2, Mat4x4<skMath>* out, size_t count) {
+		for (size_t i = 0; i < count; i++) {
+			Mat4x4<skMath> a(mat1[i]);
+			Mat4x4<skMath> b(mat2[i]);
+			out[i] = multMat4(a, b);
+		}
+	}
+	// out[i] = multVect4(mat1, vects[i])
+	static void multVect4Batch(const Mat4x4<skMath>& mat1, const Vect4<skMath>* vects, Vect4<skMath>* out, size_t count) {
+		for (size_t i = 0; i < count; i++) {
+			out[i] = multVect4(mat1, vects[i]);
+		}
+	}
+	// General 4x4 inverse, singular input gives inf/nan like glm::inverse
+	static Mat4x4<skMath> inverse(const Mat4x4<skMath>& mat1) {
+		Mat4x4<skMath> result;
+		skScalarKernels::inverse4(mat1.data(), result.data());
+		return result;
+	}
+	// Upper 3x3 has orthonormal columns (rotation plus translation only)
+	static bool isRigid(const Mat4x4<skMath>& mat1) {
+		return skScalarKernels::isRigid(mat1.data(), (skMath)1e-4);
+	}
+	// Inverse for matrices whose bottom row is (0, 0, 0, 1); rigid input takes the transpose path
+	static Mat4x4<skMath> affineInverse(const Mat4x4<skMath>& mat1) {
+		Mat4x4<skMath> result;
+		skScalarKernels::affineInverse4(mat1.data(), result.data());
+		return result;
+	}
+	// transpose(inverse(upper 3x3)) for transforming normals, rest of the matrix is identity
+	static Mat4x4<skMath> normalMatrix(const Mat4x4<skMath>& mat1) {
+		Mat4x4<skMath> result;
+		skScalarKernels::normalMatrix4(mat1.data(), result.data());
+		return result;
+	}
+	// Batched versions, out may alias mats
+	static void inverseBatch(const Mat4x4<skMath>* mats, Mat4x4<skMath>* out, size_t count) {
+		for (size_t i = 0; i < count; i++) {
+			out[i] = inverse(mats[i]);
+		}
 	}
-	static Mat4x4<skMath> translateMat4(Mat4x4<skMath>& mat1, Vect3<skMath> translateVec) {
-		Mat4x4<skMath> temp(mat1);
-		temp.row1.x += translateVec.x;
-		temp.row2.y += translateVec.y;
-		temp.row3.z += translateVec.z;
-		return temp;
+	static void affineInverseBatch(const Mat4x4<skMath>* mats, Mat4x4<skMath>* out, size_t count) {
+		for (size_t i = 0; i < count; i++) {
+			out[i] = affineInverse(mats[i]);
+		}
 	}
+	static void normalMatrixBatch(const Mat4x4<skMath>* mats, Mat4x4<skMath>* out, size_t count) {
+		for (size_t i = 0; i < count; i++) {
+			out[i] = normalMatrix(mats[i]);
+		}
+	}
+	// Scale applied before mat1, like glm::scale
+	static constexpr Mat4x4<skMath> scalingMat4(const Mat4x4<skMath>& mat1, Vect4<skMath> scaleVec) {
+		return Mat4x4<skMath>(mat1.row1 * scaleVec.x, mat1.row2 * scaleVec.y, mat1.row3 * scaleVec.z, mat1.row4);
+	}
+	// Translation applied before mat1, like glm::translate
+	static constexpr Mat4x4<skMath> translateMat4(const Mat4x4<skMath>& mat1, Vect3<skMath> translateVec) {
+		return Mat4x4<skMath>(mat1.row1, mat1.row2, mat1.row3,
+			mat1.row1 * translateVec.x + mat1.row2 * translateVec.y + mat1.row3 * translateVec.z + mat1.row4);
+	}
+	// Rotation of angle degrees about axis (normalized here) applied before mat1, like glm::rotate
 	static Mat4x4<skMath> rotateMat4(Mat4x4<skMath>& mat1, GLfloat angle, Vect3<skMath> axisToRotate) {
+		skMath theta = toRad(angle);
+		skMath inv = 1 / std::sqrt(axisToRotate.x * axisToRotate.x + axisToRotate.y * axisToRotate.y + axisToRotate.z * axisToRotate.z);
+		skMath x = axisToRotate.x * inv, y = axisToRotate.y * inv, z = axisToRotate.z * inv;
+		skMath c = std::cos(theta);
+		skMath s = std::sin(theta);
+		skMath t = 1 - c;
+		Mat4x4<skMath> rot(
+			Vect4<skMath>(t * x * x + c, t * x * y + s * z, t * x * z - s * y, 0),
+			Vect4<skMath>(t * x * y - s * z, t * y * y + c, t * y * z + s * x, 0),
+			Vect4<skMath>(t * x * z + s * y, t * y * z - s * x, t * z * z + c, 0),
+			Vect4<skMath>(0, 0, 0, 1));
+		return multMat4(rot, mat1);
+	}
+	// Pointer view over the 16 values, no copy
+	skMath* data() {
+		return &row1.x;
+	}
+	const skMath* data() const {
+		return &row1.x;
+	}
+};
 
-		float theta = angle * (PI / 180.0f);
+// Non-owning view over contiguous matrices for streaming into uniform/instance buffers
+template<class skMath>
+struct Mat4Span {
+	const Mat4x4<skMath>* mats;
+	size_t count;
 
-		Mat4x4<skMath> x_rotate = {
-			Vect4<skMath>(axisToRotate.x, 0.0f, 0.0f, 0.0f),
-			Vect4<skMath>(0.0f, cosf(theta) * axisToRotate.y, -sin(theta) * axisToRotate.z, 0.0f),
-			Vect4<skMath>(0.0f, sin(theta) * axisToRotate.y, cosf(theta) * axisToRotate.z, 0.0f),
-			Vect4<skMath>(0.0f, 0.0f, 0.0f, 1.0f)
-		};
-		Mat4x4<skMath> y_rotate = {
-			Vect4<skMath>(cosf(theta) * axisToRotate.x, 0.0f, sin(theta) * axisToRotate.z, 0.0f),
-			Vect4<skMath>(0.0f, axisToRotate.y, 0.0f, 0.0f),
-			Vect4<skMath>(-sin(theta) * axisToRotate.x, 0.0f, cosf(theta) * axisToRotate.z, 0.0f),
-			Vect4<skMath>(0.0f, 0.0f, 0.0f, 1.0f)
-		};
-		Mat4x4<skMath> z_rotate = {
-			Vect4<skMath>(cosf(theta) * axisToRotate.x, -sin(theta) * axisToRotate.y, 0.0f, 0.0f),
-			Vect4<skMath>(sin(theta) * axisToRotate.x, cosf(theta) * axisToRotate.y, 0.0f, 0.0f),
-			Vect4<skMath>(0.0f, 0.0f, axisToRotate.z, 0.0f),
-			Vect4<skMath>(0.0f, 0.0f, 0.0f, 1.0f)
-		};
+	Mat4Span(const Mat4x4<skMath>* mats, size_t count) : mats(mats), count(count) {}
+	// nullptr for an empty span built from nullptr
+	const skMath* data() const {
+		return mats ? mats->data() : nullptr;
 	}
-	std::vector<skMath> getRawData() const {
-		return{
-			row1.x,row1.y,row1.z,row1.w,
-			row2.x,row2.y,row2.z,row2.w,
-			row3.x,row3.y,row3.z,row3.w,
-			row4.x,row4.y,row4.z,row4.w
-		};
+	size_t sizeBytes() const {
+		return count * sizeof(Mat4x4<skMath>);
+	}
+	Mat4Span<skMath> subspan(size_t first, size_t n) const {
+		return Mat4Span<skMath>(mats + first, n);
+	}
+	// Tightly packed copy, e.g. into a mapped GL buffer
+	void copyTo(void* dst) const {
+		memcpy(dst, mats, sizeBytes());
+	}
+	// Interleaved copy for instance buffers where each record holds more than the matrix
+	void copyTo(void* dst, size_t dstStride) const {
+		unsigned char* out = static_cast<unsigned char*>(dst);
+		for (size_t i = 0; i < count; i++) {
+			memcpy(out + i * dstStride, mats + i, sizeof(Mat4x4<skMath>));
+		}
 	}
 };
 
+// Mat4x4<float> routes through the SIMD kernel table picked from CPUID (see skSimd.h)
+static_assert(sizeof(Mat4x4<float>) == 16 * sizeof(float), "Mat4x4<float> must be 16 packed floats");
+static_assert(sizeof(Vect4<float>) == 4 * sizeof(float), "Vect4<float> must be 4 packed floats");
+static_assert(alignof(Mat4x4<float>) == 16, "Mat4x4<float> must be 16-byte aligned for SIMD and buffer uploads");
+
+template<>
+inline Mat4x4<float> Mat4x4<float>::addMat4(Mat4x4<float> mat1, Mat4x4<float> mat2) {
+	Mat4x4<float> result;
+	skKernels::active().addMat4(mat1.data(), mat2.data(), result.data());
+	return result;
+}
+template<>
+inline Mat4x4<float> Mat4x4<float>::multMat4(Mat4x4<float>& mat1, Mat4x4<float>& mat2) {
+	Mat4x4<float> result;
+	skKernels::active().multMat4(mat1.data(), mat2.data(), result.data());
+	return result;
+}
+template<>
+inline Vect4<float> Mat4x4<float>::multVect4(const Mat4x4<float>& mat1, Vect4<float> vect) {
+	Vect4<float> result;
+	skKernels::active().multVect4(mat1.data(), &vect.x, &result.x);
+	return result;
+}
+template<>
+inline void Mat4x4<float>::multMat4Batch(const Mat4x4<float>* mat1, const Mat4x4<float>* mat2, Mat4x4<float>* out, size_t count) {
+	skKernels::active().multMat4Batch(mat1->data(), mat2->data(), out->data(), count);
+}
+template<>
+inline void Mat4x4<float>::multVect4Batch(const Mat4x4<float>& mat1, const Vect4<float>* vects, Vect4<float>* out, size_t count) {
+	skKernels::active().multVect4Batch(mat1.data(), &vects->x, &out->x, count);
+}
+template<>
+inline void Mat4x4<float>::inverseBatch(const Mat4x4<float>* mats, Mat4x4<float>* out, size_t count) {
+	skKernels::active().inverseBatch(mats->data(), out->data(), count);
+}
+template<>
+inline void Mat4x4<float>::affineInverseBatch(const Mat4x4<float>* mats, Mat4x4<float>* out, size_t count) {
+	skKernels::active().affineInverseBatch(mats->data(), out->data(), count);
+}
+template<>
+inline void Mat4x4<float>::normalMatrixBatch(const Mat4x4<float>* mats, Mat4x4<float>* out, size_t count) {
+	skKernels::active().normalMatrixBatch(mats->data(), out->data(), count);
+}
+
+// Batched instance transforms from structure-of-arrays input (see skTransformSoA).
+// Writes count column-major 4x4 matrices, T * R * S like glm, ready for glUniformMatrix4fv
+struct TransformBatch {
+	static void composeAxisAngle(const skTransformSoA& soa, float* out, size_t count) {
+		skKernels::active().composeAxisAngle(soa, out, count);
+	}
+	static void composeQuat(const skTransformSoA& soa, float* out, size_t count) {
+		skKernels::active().composeQuat(soa, out, count);
+	}
+};
+
+// Unit quaternions are rotations, q holds (x, y, z, w) with w the scalar part
 template <class skMath>
 struct Quaternion {
 	Vect4<skMath> q;
-	Vect3<skMath> p;
 	Quaternion() {
 		q = Vect4<skMath>(0.0f, 0.0f, 0.0f, 1.0f);
-		p = Vect3<skMath>(0.0f, 0.0f, 0.0f);
+	}
+	Quaternion(skMath x, skMath y, skMath z, skMath w) {
+		q = Vect4<skMath>(x, y, z, w);
 	}
 	Quaternion(const Quaternion<skMath>& other) {
 		this->q = other.q;
-		this->p = other.p;
+	}
+	Quaternion<skMath>& operator=(const Quaternion<skMath>& other) {
+		this->q = other.q;
+		return *this;
 	}
 	static skMath squ(skMath s) {
 		skMath a = s * s;
 		return a;
 	}
-	static Quaternion<skMath> mult(Quaternion<skMath>& q1) {
-		Quaternion<skMath> temp;
-		temp.q.w = 1;
-		temp.q.x = (q1.p.x * squ(q1.q.w) + q1.p.x * squ(q1.q.x) - q1.p.x * squ(q1.q.y) - q1.p.x * squ(q1.q.z)) + ((2 * q1.p.y) * q1.q.x * q1.q.y - (2 * q1.p.y) * q1.q.w * q1.q.z) + ((2 * q1.p.z) * q1.q.w * q1.q.y + (2 * q1.p.z) * q1.q.x * q1.q.z);
-		temp.q.y = ((2 * q1.p.x) * q1.q.w * q1.q.z + (2 * q1.p.x) * q1.q.x * q1.q.y) + (q1.p.y * squ(q1.q.w) - q1.p.y * squ(q1.q.x) + q1.p.y * squ(q1.q.y) - q1.p.y * squ(q1.q.z)) + ((2 * q1.p.z) * q1.q.y * q1.q.z + (2 * q1.p.z) * q1.q.w * q1.q.x);
-		temp.q.z = ((2 * q1.p.x) * q1.q.x * q1.q.z - (2 * q1.p.x) * q1.q.w * q1.q.y) + ((2 * q1.p.y) * q1.q.w * q1.q.x + (2 * q1.p.y) * q1.q.y * q1.q.z) + (q1.p.z * squ(q1.q.w) - q1.p.z * squ(q1.q.x) - q1.p.z * squ(q1.q.y) + q1.p.z * squ(q1.q.z));
-
-		return temp;
+	static skMath dot(const Quaternion<skMath>& q1, const Quaternion<skMath>& q2) {
+		return q1.q.x * q2.q.x + q1.q.y * q2.q.y + q1.q.z * q2.q.z + q1.q.w * q2.q.w;
+	}
+	static Quaternion<skMath> conjugate(const Quaternion<skMath>& q1) {
+		return Quaternion<skMath>(-q1.q.x, -q1.q.y, -q1.q.z, q1.q.w);
+	}
+	// Hamilton product, the result rotates by q2 first then q1
+	static Quaternion<skMath> mult(const Quaternion<skMath>& q1, const Quaternion<skMath>& q2) {
+		const Vect4<skMath>& a = q1.q;
+		const Vect4<skMath>& b = q2.q;
+		return Quaternion<skMath>(
+			a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+			a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+			a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+			a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z);
+	}
+	// q * p * q^-1 for a unit q, expanded so it costs two cross products
+	static Vect3<skMath> rotateVect3(const Quaternion<skMath>& q1, Vect3<skMath> p) {
+		const Vect4<skMath>& r = q1.q;
+		skMath tx = 2 * (r.y * p.z - r.z * p.y);
+		skMath ty = 2 * (r.z * p.x - r.x * p.z);
+		skMath tz = 2 * (r.x * p.y - r.y * p.x);
+		return Vect3<skMath>(
+			p.x + r.w * tx + (r.y * tz - r.z * ty),
+			p.y + r.w * ty + (r.z * tx - r.x * tz),
+			p.z + r.w * tz + (r.x * ty - r.y * tx));
 	}
-	static Quaternion<skMath> normalize(Vect4<skMath>& q1) {
-		float m = sqrt(squ(q1.w) + squ(q1.x) + squ(q1.y) + squ(q1.z));
-		q1.w = m;
-		q1.x = m;
-		q1.y = m;
-		q1.z = m;
-		return q1;
+	static Quaternion<skMath> normalize(const Quaternion<skMath>& q1) {
+		skMath m = std::sqrt(dot(q1, q1));
+		if (m == 0) {
+			return Quaternion<skMath>();
+		}
+		skMath inv = 1 / m;
+		return Quaternion<skMath>(q1.q.x * inv, q1.q.y * inv, q1.q.z * inv, q1.q.w * inv);
+	}
+	// Normalized lerp along the shortest arc, cheap and fine for small angles
+	static Quaternion<skMath> nlerp(const Quaternion<skMath>& q1, const Quaternion<skMath>& q2, skMath t) {
+		skMath s = dot(q1, q2) < 0 ? -t : t;
+		skMath r = 1 - t;
+		return normalize(Quaternion<skMath>(
+			r * q1.q.x + s * q2.q.x, r * q1.q.y + s * q2.q.y,
+			r * q1.q.z + s * q2.q.z, r * q1.q.w + s * q2.q.w));
+	}
+	// Constant angular velocity interpolation along the shortest arc
+	static Quaternion<skMath> slerp(const Quaternion<skMath>& q1, const Quaternion<skMath>& q2, skMath t) {
+		skMath d = dot(q1, q2);
+		skMath sign = 1;
+		if (d < 0) {
+			d = -d;
+			sign = -1;
+		}
+		// nearly parallel, sin(theta) ~ 0 so fall back to nlerp
+		if (d > (skMath)0.9995) {
+			return nlerp(q1, q2, t);
+		}
+		skMath theta = std::acos(d);
+		skMath invSin = 1 / std::sin(theta);
+		skMath w1 = std::sin((1 - t) * theta) * invSin;
+		skMath w2 = sign * std::sin(t * theta) * invSin;
+		return Quaternion<skMath>(
+			w1 * q1.q.x + w2 * q2.q.x, w1 * q1.q.y + w2 * q2.q.y,
+			w1 * q1.q.z + w2 * q2.q.z, w1 * q1.q.w + w2 * q2.q.w);
 	}
+	// Scales the upper 3x3 of mat1
 	static Mat4x4<skMath> scalar(Mat4x4<skMath>& mat1, skMath scNum) {
 		Mat4x4<skMath> tmp(mat1);
 		tmp.row1.x *= scNum;
@@ -196,68 +577,272 @@ struct Quaternion {
 		tmp.row2.y *= scNum;
 		tmp.row2.z *= scNum;
 
-		tmp.row3.z *= scNum;
+		tmp.row3.x *= scNum;
 		tmp.row3.y *= scNum;
 		tmp.row3.z *= scNum;
 		return tmp;
 	}
-	static Mat4x4<skMath> quatToMat(Quaternion<skMath>& rotA) {
-		float x1 = squ(rotA.q.w) + squ(rotA.q.x) - 0.5f;
-		float x2 = rotA.q.x * rotA.q.y - rotA.q.w * rotA.q.z;
-		float x3 = rotA.q.w * rotA.q.y + rotA.q.x * rotA.q.z;
-
-		float y1 = rotA.q.w * rotA.q.z + rotA.q.x * rotA.q.y;
-		float y2 = squ(rotA.q.w) + squ(rotA.q.y) - 0.5f;
-		float y3 = rotA.q.y * rotA.q.z - rotA.q.w * rotA.q.x;
-
-		float z1 = rotA.q.x * rotA.q.z - rotA.q.w * rotA.q.y;
-		float z2 = rotA.q.w * rotA.q.x + rotA.q.y * rotA.q.z;
-		float z3 = squ(rotA.q.w) + squ(rotA.q.z) - 0.5f;
-		// may need *2
+	// Column-major rotation matrix, same layout as Mat4x4::perspective
+	static Mat4x4<skMath> quatToMat(const Quaternion<skMath>& rotA) {
+		const Vect4<skMath>& r = rotA.q;
+		skMath xx = r.x * r.x, yy = r.y * r.y, zz = r.z * r.z;
+		skMath xy = r.x * r.y, xz = r.x * r.z, yz = r.y * r.z;
+		skMath wx = r.w * r.x, wy = r.w * r.y, wz = r.w * r.z;
 		Mat4x4<skMath> rotM = {
-			Vect4<skMath>(x1,   x2,   x3, 0.0f),
-			Vect4<skMath>(y1,   y2,   y3, 0.0f),
-			Vect4<skMath>(z1,   z2,   z3, 0.0f),
+			Vect4<skMath>(1 - 2 * (yy + zz), 2 * (xy + wz), 2 * (xz - wy), 0.0f),
+			Vect4<skMath>(2 * (xy - wz), 1 - 2 * (xx + zz), 2 * (yz + wx), 0.0f),
+			Vect4<skMath>(2 * (xz + wy), 2 * (yz - wx), 1 - 2 * (xx + yy), 0.0f),
 			Vect4<skMath>(0.0f, 0.0f, 0.0f, 1.0f)
 		};
 		return rotM;
 	}
-	static Quaternion<skMath> matToQuat(Mat4x4<skMath>& mat1) {
+	// Upper 3x3 of mat1 must be a pure rotation. Picks the largest diagonal term for stability
+	static Quaternion<skMath> matToQuat(const Mat4x4<skMath>& mat1) {
+		// m(r, c) with r the math row, c the column
+		skMath m00 = mat1.row1.x, m11 = mat1.row2.y, m22 = mat1.row3.z;
+		skMath m10 = mat1.row1.y, m20 = mat1.row1.z, m01 = mat1.row2.x;
+		skMath m21 = mat1.row2.z, m02 = mat1.row3.x, m12 = mat1.row3.y;
+		skMath trace = m00 + m11 + m22;
 		Quaternion<skMath> temp;
-		float trcM = (4 * squ(mat1.row4.w)) - 1;
-		temp.q.w = sqrt((trcM + 1) / 4);
-		temp.q.x = sqrt(mat1.row1.x / 2) + ((1 - trcM) / 4);
-		temp.q.y = sqrt(mat1.row2.y / 2) + ((1 - trcM) / 4);
-		temp.q.z = sqrt(mat1.row3.z / 2) + ((1 - trcM) / 4);
-		return temp;
+		if (trace > 0) {
+			skMath s = std::sqrt(trace + 1) * 2;
+			temp.q = Vect4<skMath>((m21 - m12) / s, (m02 - m20) / s, (m10 - m01) / s, s / 4);
+		}
+		else if (m00 > m11 && m00 > m22) {
+			skMath s = std::sqrt(1 + m00 - m11 - m22) * 2;
+			temp.q = Vect4<skMath>(s / 4, (m01 + m10) / s, (m02 + m20) / s, (m21 - m12) / s);
+		}
+		else if (m11 > m22) {
+			skMath s = std::sqrt(1 + m11 - m00 - m22) * 2;
+			temp.q = Vect4<skMath>((m01 + m10) / s, s / 4, (m12 + m21) / s, (m02 - m20) / s);
+		}
+		else {
+			skMath s = std::sqrt(1 + m22 - m00 - m11) * 2;
+			temp.q = Vect4<skMath>((m02 + m20) / s, (m12 + m21) / s, s / 4, (m10 - m01) / s);
+		}
+		return normalize(temp);
 	}
+	// Axis-angle to quaternion, angle in radians, axis normalized here
 	static Quaternion<skMath> eAngToQuat(Vect3<skMath> axis, GLfloat angle) {
-		Quaternion<skMath> temp;
-		if (axis.x != 0.0f) {
-			angle *= axis.x;
-			temp.p.x = cosf(angle / 2) + sinf(angle / 2);
+		skMath len = std::sqrt(axis.x * axis.x + axis.y * axis.y + axis.z * axis.z);
+		if (len == 0) {
+			return Quaternion<skMath>();
+		}
+		skMath s = std::sin(angle / 2) / len;
+		return Quaternion<skMath>(axis.x * s, axis.y * s, axis.z * s, std::cos(angle / 2));
+	}
+	// Same contract as Mat4x4::rotateMat4, angle in degrees
+	static Mat4x4<skMath> rotate(Mat4x4<skMath>& mat1, GLfloat rAngle, Vect3<skMath> rotA) {
+		Mat4x4<skMath> fMat = quatToMat(eAngToQuat(rotA, Mat4x4<skMath>::toRad(rAngle)));
+		return Mat4x4<skMath>::multMat4(fMat, mat1);
+	}
+};
+
+// Batched quaternion kernels over structure-of-arrays data, 4 (SSE4.1) or 8 (AVX2) per step.
+// Outputs may alias inputs. Matrices are written column-major like TransformBatch
+struct QuaternionBatch {
+	static void mult(const skQuatSoA& a, const skQuatSoA& b, const skQuatSoA& out, size_t count) {
+		skKernels::active().quatMult(a, b, out, count);
+	}
+	static void normalize(const skQuatSoA& in, const skQuatSoA& out, size_t count) {
+		skKernels::active().quatNormalize(in, out, count);
+	}
+	static void nlerp(const skQuatSoA& a, const skQuatSoA& b, const float* t, const skQuatSoA& out, size_t count) {
+		skKernels::active().quatNlerp(a, b, t, out, count);
+	}
+	static void slerp(const skQuatSoA& a, const skQuatSoA& b, const float* t, const skQuatSoA& out, size_t count) {
+		skKernels::active().quatSlerp(a, b, t, out, count);
+	}
+	static void toMat4(const skQuatSoA& in, float* out, size_t count) {
+		skKernels::active().quatToMat(in, out, count);
+	}
+};
+// Plane as dot(normal, p) + d = 0, the positive side is inside
+template<class skMath>
+struct Plane {
+	Vect3<skMath> normal;
+	skMath d;
+	constexpr Plane() : normal(), d(0) {}
+	constexpr Plane(Vect3<skMath> normal, skMath d) : normal(normal), d(d) {}
+	constexpr skMath distance(const Vect3<skMath>& p) const {
+		return Vect3<skMath>::dot(normal, p) + d;
+	}
+	// Unit normal so distance() is in world units, needed for sphere tests
+	static Plane<skMath> normalize(const Plane<skMath>& plane) {
+		skMath len = std::sqrt(Vect3<skMath>::dot(plane.normal, plane.normal));
+		if (len <= 0) {
+			return plane;
 		}
-		if (axis.y != 0.0f){
-			angle *= axis.y;
-			temp.p.y = cosf(angle / 2) + sin(angle / 2);
+		skMath inv = 1 / len;
+		return Plane<skMath>(plane.normal * inv, plane.d * inv);
+	}
+};
+
+template<class skMath>
+struct AABB {
+	Vect3<skMath> min, max;
+	constexpr AABB() : min(), max() {}
+	constexpr AABB(Vect3<skMath> min, Vect3<skMath> max) : min(min), max(max) {}
+	constexpr Vect3<skMath> center() const {
+		return (min + max) * (skMath)0.5;
+	}
+	constexpr Vect3<skMath> extent() const {
+		return (max - min) * (skMath)0.5;
+	}
+	// Box around the transformed box (Arvo): the new half extent is |M| * extent
+	static AABB<skMath> transform(const Mat4x4<skMath>& mat1, const AABB<skMath>& box) {
+		Vect3<skMath> c = box.center(), e = box.extent();
+		Vect4<skMath> wc = mat1 * Vect4<skMath>(c.x, c.y, c.z, 1);
+		Vect3<skMath> we(
+			std::fabs(mat1.row1.x) * e.x + std::fabs(mat1.row2.x) * e.y + std::fabs(mat1.row3.x) * e.z,
+			std::fabs(mat1.row1.y) * e.x + std::fabs(mat1.row2.y) * e.y + std::fabs(mat1.row3.y) * e.z,
+			std::fabs(mat1.row1.z) * e.x + std::fabs(mat1.row2.z) * e.y + std::fabs(mat1.row3.z) * e.z);
+		Vect3<skMath> center(wc.x, wc.y, wc.z);
+		return AABB<skMath>(center - we, center + we);
+	}
+};
+
+template<class skMath>
+struct Sphere {
+	Vect3<skMath> center;
+	skMath radius;
+	constexpr Sphere() : center(), radius(0) {}
+	constexpr Sphere(Vect3<skMath> center, skMath radius) : center(center), radius(radius) {}
+};
+
+// Six inward facing planes in the order left, right, bottom, top, near, far
+template<class skMath>
+struct Frustum {
+	Plane<skMath> planes[6];
+
+	// Gribb/Hartmann extraction from projection * view (GL clip space, -w <= z <= w).
+	// Pass projection alone to get view space planes
+	static Frustum<skMath> fromMatrix(const Mat4x4<skMath>& viewProj) {
+		const Mat4x4<skMath>& m = viewProj;
+		// storage is column-major so row r of the matrix is component r of each column
+		Vect4<skMath> r0(m.row1.x, m.row2.x, m.row3.x, m.row4.x);
+		Vect4<skMath> r1(m.row1.y, m.row2.y, m.row3.y, m.row4.y);
+		Vect4<skMath> r2(m.row1.z, m.row2.z, m.row3.z, m.row4.z);
+		Vect4<skMath> r3(m.row1.w, m.row2.w, m.row3.w, m.row4.w);
+		Frustum<skMath> f;
+		f.planes[0] = fromRow(r3 + r0);
+		f.planes[1] = fromRow(r3 + r0 * (skMath)-1);
+		f.planes[2] = fromRow(r3 + r1);
+		f.planes[3] = fromRow(r3 + r1 * (skMath)-1);
+		f.planes[4] = fromRow(r3 + r2);
+		f.planes[5] = fromRow(r3 + r2 * (skMath)-1);
+		return f;
+	}
+	static Plane<skMath> fromRow(Vect4<skMath> r) {
+		return Plane<skMath>::normalize(Plane<skMath>(Vect3<skMath>(r.x, r.y, r.z), r.w));
+	}
+	// Conservative: boxes straddling a frustum corner can pass, nothing visible is rejected
+	bool intersects(const AABB<skMath>& box) const {
+		Vect3<skMath> c = box.center(), e = box.extent();
+		for (int p = 0; p < 6; p++) {
+			const Vect3<skMath>& n = planes[p].normal;
+			skMath r = std::fabs(n.x) * e.x + std::fabs(n.y) * e.y + std::fabs(n.z) * e.z;
+			if (planes[p].distance(c) + r < 0) {
+				return false;
+			}
 		}
-		if (axis.z != 0.0f) {
-			angle *= axis.z;
-			temp.p.z = cosf(angle / 2) + sin(angle / 2);
+		return true;
+	}
+	bool intersects(const Sphere<skMath>& sphere) const {
+		for (int p = 0; p < 6; p++) {
+			if (planes[p].distance(sphere.center) + sphere.radius < 0) {
+				return false;
+			}
 		}
-		return temp;
+		return true;
 	}
-	static Mat4x4<skMath> rotate(Mat4x4<skMath>& mat1, GLfloat rAngle, Vect3<skMath> rotA) {
-		rAngle = rAngle * (PI / 180.0f);
-		Mat4x4<skMath> mat = Mat4x4<skMath>::identityMatrix();
-		Quaternion<skMath> q = matToQuat(mat);
-		Quaternion<skMath> p = eAngToQuat(rotA, rAngle);
-		
-		q.p = p.p;
-		q = mult(q);
-		Mat4x4<skMath> fMat = quatToMat(q);
-		fMat = Mat4x4<skMath>::multMat4(mat1, fMat);
-		return fMat;
+	// 6 x (nx, ny, nz, d), the layout the culling kernels take
+	void pack(float out[24]) const {
+		for (int p = 0; p < 6; p++) {
+			out[p * 4 + 0] = (float)planes[p].normal.x;
+			out[p * 4 + 1] = (float)planes[p].normal.y;
+			out[p * 4 + 2] = (float)planes[p].normal.z;
+			out[p * 4 + 3] = (float)planes[p].d;
+		}
+	}
+};
+
+// Batched frustum culling over structure-of-arrays volumes, 4 (SSE4.1) or 8 (AVX2) volumes
+// against all six planes per step. visible[i] gets 1 or 0, returns the visible count
+struct FrustumCull {
+	static size_t aabbs(const Frustum<float>& frustum, const skAabbSoA& soa, unsigned char* visible, size_t count) {
+		float planes[24];
+		frustum.pack(planes);
+		return skKernels::active().cullAabb(planes, soa, visible, count);
+	}
+	static size_t spheres(const Frustum<float>& frustum, const skSphereSoA& soa, unsigned char* visible, size_t count) {
+		float planes[24];
+		frustum.pack(planes);
+		return skKernels::active().cullSphere(planes, soa, visible, count);
+	}
+};
+// Vertex and instance compression. Halves for positions/UVs, normalized integers for
+// colors and weights, octahedral snorm16 pairs for unit normals (GL_SHORT, normalized)
+struct Pack {
+	static uint16_t half(float value) {
+		return skScalarKernels::floatToHalf(value);
+	}
+	static float unpackHalf(uint16_t value) {
+		return skScalarKernels::halfToFloat(value);
+	}
+	static int16_t snorm16(float value) {
+		return skScalarKernels::packSnorm16(value);
+	}
+	static uint16_t unorm16(float value) {
+		return skScalarKernels::packUnorm16(value);
+	}
+	static uint8_t unorm8(float value) {
+		return skScalarKernels::packUnorm8(value);
+	}
+	static float unpackSnorm16(int16_t value) {
+		float f = value / 32767.0f;
+		return f < -1.0f ? -1.0f : f;
+	}
+	static float unpackUnorm16(uint16_t value) {
+		return value / 65535.0f;
+	}
+	static float unpackUnorm8(uint8_t value) {
+		return value / 255.0f;
+	}
+	static void octEncode(const Vect3<float>& n, int16_t out[2]) {
+		skScalarKernels::octEncode(n.x, n.y, n.z, out);
+	}
+	// Same unfold the vertex shader does after reading the normalized pair
+	static Vect3<float> octDecode(const int16_t in[2]) {
+		float x = unpackSnorm16(in[0]), y = unpackSnorm16(in[1]);
+		float z = 1.0f - std::fabs(x) - std::fabs(y);
+		float t = z < 0.0f ? -z : 0.0f;
+		x += x >= 0.0f ? -t : t;
+		y += y >= 0.0f ? -t : t;
+		return Vect3<float>::normalizeVect(Vect3<float>(x, y, z));
+	}
+};
+
+// Batched packing for asset import and per-frame instance uploads, F16C on the AVX2 tier.
+// octEncode writes interleaved (u, v) pairs, 2 * count values
+struct PackBatch {
+	static void half(const float* in, uint16_t* out, size_t count) {
+		skKernels::active().floatToHalfBatch(in, out, count);
+	}
+	static void unpackHalf(const uint16_t* in, float* out, size_t count) {
+		skKernels::active().halfToFloatBatch(in, out, count);
+	}
+	static void snorm16(const float* in, int16_t* out, size_t count) {
+		skKernels::active().packSnorm16Batch(in, out, count);
+	}
+	static void unorm16(const float* in, uint16_t* out, size_t count) {
+		skKernels::active().packUnorm16Batch(in, out, count);
+	}
+	static void unorm8(const float* in, uint8_t* out, size_t count) {
+		skKernels::active().packUnorm8Batch(in, out, count);
+	}
+	static void octEncode(const float* x, const float* y, const float* z, int16_t* out, size_t count) {
+		skKernels::active().octEncodeBatch(x, y, z, out, count);
 	}
 };
 #endif // !SKMATH_H
\ No newline at end of file
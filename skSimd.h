@@ -0,0 +1,1874 @@
+// Valor engine by Valores M.
+// Runtime CPU detection and SIMD kernels backing skMath
+#ifndef SKSIMD_H
+#define SKSIMD_H
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SK_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+// MSVC lets any function use any intrinsic, nothing to tag
+#define SK_TARGET_SSE41
+#define SK_TARGET_AVX2
+#else
+#include <cpuid.h>
+// GCC/Clang need the ISA enabled per function so the rest of the build stays baseline x86-64
+#define SK_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define SK_TARGET_AVX2 __attribute__((target("avx2,fma,f16c")))
+#endif
+#endif
+
+enum skSimdLevel {
+	SK_SIMD_SCALAR = 0,
+	SK_SIMD_SSE41 = 1,
+	SK_SIMD_AVX2 = 2
+};
+
+struct skCpuFeatures {
+	bool sse41 = false;
+	bool avx = false;
+	bool avx2 = false;
+	bool fma = false;
+	bool f16c = false;
+
+	static skCpuFeatures detect() {
+		skCpuFeatures f;
+#ifdef SK_SIMD_X86
+		unsigned int r[4] = { 0, 0, 0, 0 };
+		cpuid(r, 0, 0);
+		unsigned int maxLeaf = r[0];
+		if (maxLeaf < 1) {
+			return f;
+		}
+		cpuid(r, 1, 0);
+		f.sse41 = (r[2] & (1u << 19)) != 0;
+		f.fma = (r[2] & (1u << 12)) != 0;
+		f.f16c = (r[2] & (1u << 29)) != 0;
+		bool osxsave = (r[2] & (1u << 27)) != 0;
+		bool avxBit = (r[2] & (1u << 28)) != 0;
+		// AVX is only usable when the OS saves the YMM registers on context switch
+		if (osxsave && avxBit) {
+			f.avx = (xgetbv0() & 0x6) == 0x6;
+		}
+		if (f.avx && maxLeaf >= 7) {
+			cpuid(r, 7, 0);
+			f.avx2 = (r[1] & (1u << 5)) != 0;
+		}
+#endif
+		return f;
+	}
+	skSimdLevel bestLevel() const {
+		// every AVX2 part ships F16C too, the AVX2 tier relies on both
+		if (avx2 && fma && f16c) {
+			return SK_SIMD_AVX2;
+		}
+		if (sse41) {
+			return SK_SIMD_SSE41;
+		}
+		return SK_SIMD_SCALAR;
+	}
+#ifdef SK_SIMD_X86
+private:
+	static void cpuid(unsigned int out[4], unsigned int leaf, unsigned int subLeaf) {
+#if defined(_MSC_VER)
+		int regs[4];
+		__cpuidex(regs, (int)leaf, (int)subLeaf);
+		for (int i = 0; i < 4; i++) {
+			out[i] = (unsigned int)regs[i];
+		}
+#else
+		__cpuid_count(leaf, subLeaf, out[0], out[1], out[2], out[3]);
+#endif
+	}
+	static unsigned long long xgetbv0() {
+#if defined(_MSC_VER)
+		return _xgetbv(0);
+#else
+		unsigned int lo, hi;
+		__asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+		return ((unsigned long long)hi << 32) | lo;
+#endif
+	}
+#endif
+};
+
+// Structure-of-arrays instance transforms for the compose kernels. Angles are radians,
+// axes need not be normalized, quaternions must be unit length, a null scale array means 1
+struct skTransformSoA {
+	const float* posX = nullptr;
+	const float* posY = nullptr;
+	const float* posZ = nullptr;
+	const float* axisX = nullptr;
+	const float* axisY = nullptr;
+	const float* axisZ = nullptr;
+	const float* angle = nullptr;
+	const float* quatX = nullptr;
+	const float* quatY = nullptr;
+	const float* quatZ = nullptr;
+	const float* quatW = nullptr;
+	const float* scaleX = nullptr;
+	const float* scaleY = nullptr;
+	const float* scaleZ = nullptr;
+};
+
+// Structure-of-arrays quaternions (x, y, z, w with w the scalar part)
+struct skQuatSoA {
+	float* x = nullptr;
+	float* y = nullptr;
+	float* z = nullptr;
+	float* w = nullptr;
+};
+
+// Eberly's polynomial slerp ("A Fast and Accurate Algorithm for Computing SLERP"), trig free
+// so it vectorizes. Weight error is below 1e-7 up to 90 degrees apart, 2e-5 at 180 degrees
+struct skSlerpConst {
+	static constexpr float mu = 1.85298109240830f;
+	static float u(int i) {
+		return i < 7 ? 1.0f / ((i + 1) * (2 * (i + 1) + 1)) : mu / (8.0f * 17.0f);
+	}
+	static float v(int i) {
+		return i < 7 ? (float)(i + 1) / (2 * (i + 1) + 1) : mu * 8.0f / 17.0f;
+	}
+};
+
+// Cephes single precision sin/cos constants, shared by the SIMD sincos paths
+struct skSinCosConst {
+	static constexpr float fourOverPi = 1.27323954473516f;
+	static constexpr float dp1 = -0.78515625f;
+	static constexpr float dp2 = -2.4187564849853515625e-4f;
+	static constexpr float dp3 = -3.77489497744594108e-8f;
+	static constexpr float sin0 = -1.9515295891e-4f;
+	static constexpr float sin1 = 8.3321608736e-3f;
+	static constexpr float sin2 = -1.6666654611e-1f;
+	static constexpr float cos0 = 2.443315711809948e-5f;
+	static constexpr float cos1 = -1.388731625493765e-3f;
+	static constexpr float cos2 = 4.166664568298827e-2f;
+};
+
+// Structure-of-arrays bounding volumes for the culling kernels. Boxes are center plus
+// half extent, which turns the plane test into one dot product and one abs-dot per plane
+struct skAabbSoA {
+	const float* centerX = nullptr;
+	const float* centerY = nullptr;
+	const float* centerZ = nullptr;
+	const float* extentX = nullptr;
+	const float* extentY = nullptr;
+	const float* extentZ = nullptr;
+};
+
+struct skSphereSoA {
+	const float* x = nullptr;
+	const float* y = nullptr;
+	const float* z = nullptr;
+	const float* radius = nullptr;
+};
+
+// Matrices are 16 contiguous floats laid out as Mat4x4 stores them (row1..row4)
+struct skScalarKernels {
+	static void multMat4(const float* a, const float* b, float* out) {
+		float tmp[16];
+		for (int i = 0; i < 4; i++) {
+			for (int j = 0; j < 4; j++) {
+				tmp[i * 4 + j] = a[i * 4 + 0] * b[0 * 4 + j] + a[i * 4 + 1] * b[1 * 4 + j] + a[i * 4 + 2] * b[2 * 4 + j] + a[i * 4 + 3] * b[3 * 4 + j];
+			}
+		}
+		for (int i = 0; i < 16; i++) {
+			out[i] = tmp[i];
+		}
+	}
+	static void multMat4Batch(const float* a, const float* b, float* out, size_t count) {
+		for (size_t n = 0; n < count; n++) {
+			multMat4(a + n * 16, b + n * 16, out + n * 16);
+		}
+	}
+	static void addMat4(const float* a, const float* b, float* out) {
+		for (int i = 0; i < 16; i++) {
+			out[i] = a[i] + b[i];
+		}
+	}
+	static void multVect4(const float* m, const float* v, float* out) {
+		float x = v[0], y = v[1], z = v[2], w = v[3];
+		for (int j = 0; j < 4; j++) {
+			out[j] = x * m[0 * 4 + j] + y * m[1 * 4 + j] + z * m[2 * 4 + j] + w * m[3 * 4 + j];
+		}
+	}
+	static void multVect4Batch(const float* m, const float* v, float* out, size_t count) {
+		for (size_t n = 0; n < count; n++) {
+			multVect4(m, v + n * 4, out + n * 4);
+		}
+	}
+	// Column-major T * R * S, columns are the rotation basis scaled, then the translation
+	static void writeTRS(float* o, const float r[9], float sx, float sy, float sz, float px, float py, float pz) {
+		o[0] = r[0] * sx; o[1] = r[1] * sx; o[2] = r[2] * sx; o[3] = 0.0f;
+		o[4] = r[3] * sy; o[5] = r[4] * sy; o[6] = r[5] * sy; o[7] = 0.0f;
+		o[8] = r[6] * sz; o[9] = r[7] * sz; o[10] = r[8] * sz; o[11] = 0.0f;
+		o[12] = px; o[13] = py; o[14] = pz; o[15] = 1.0f;
+	}
+	static float scaleAt(const float* s, size_t i) {
+		return s ? s[i] : 1.0f;
+	}
+	static void composeAxisAngleRange(const skTransformSoA& soa, float* out, size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			float x = soa.axisX[i], y = soa.axisY[i], z = soa.axisZ[i];
+			float inv = 1.0f / sqrtf(x * x + y * y + z * z);
+			x *= inv; y *= inv; z *= inv;
+			float s = sinf(soa.angle[i]);
+			float c = cosf(soa.angle[i]);
+			float t = 1.0f - c;
+			float r[9] = {
+				t * x * x + c,     t * x * y + s * z, t * x * z - s * y,
+				t * x * y - s * z, t * y * y + c,     t * y * z + s * x,
+				t * x * z + s * y, t * y * z - s * x, t * z * z + c
+			};
+			writeTRS(out + i * 16, r, scaleAt(soa.scaleX, i), scaleAt(soa.scaleY, i), scaleAt(soa.scaleZ, i), soa.posX[i], soa.posY[i], soa.posZ[i]);
+		}
+	}
+	// Column-major 3x3 rotation basis of a unit quaternion
+	static void quatBasis(float x, float y, float z, float w, float r[9]) {
+		r[0] = 1.0f - 2.0f * (y * y + z * z); r[1] = 2.0f * (x * y + w * z);        r[2] = 2.0f * (x * z - w * y);
+		r[3] = 2.0f * (x * y - w * z);        r[4] = 1.0f - 2.0f * (x * x + z * z); r[5] = 2.0f * (y * z + w * x);
+		r[6] = 2.0f * (x * z + w * y);        r[7] = 2.0f * (y * z - w * x);        r[8] = 1.0f - 2.0f * (x * x + y * y);
+	}
+	static void composeQuatRange(const skTransformSoA& soa, float* out, size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			float r[9];
+			quatBasis(soa.quatX[i], soa.quatY[i], soa.quatZ[i], soa.quatW[i], r);
+			writeTRS(out + i * 16, r, scaleAt(soa.scaleX, i), scaleAt(soa.scaleY, i), scaleAt(soa.scaleZ, i), soa.posX[i], soa.posY[i], soa.posZ[i]);
+		}
+	}
+	static void composeAxisAngle(const skTransformSoA& soa, float* out, size_t count) {
+		composeAxisAngleRange(soa, out, 0, count);
+	}
+	static void composeQuat(const skTransformSoA& soa, float* out, size_t count) {
+		composeQuatRange(soa, out, 0, count);
+	}
+	static void quatMultRange(const skQuatSoA& a, const skQuatSoA& b, const skQuatSoA& out, size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			float ax = a.x[i], ay = a.y[i], az = a.z[i], aw = a.w[i];
+			float bx = b.x[i], by = b.y[i], bz = b.z[i], bw = b.w[i];
+			out.x[i] = aw * bx + ax * bw + ay * bz - az * by;
+			out.y[i] = aw * by - ax * bz + ay * bw + az * bx;
+			out.z[i] = aw * bz + ax * by - ay * bx + az * bw;
+			out.w[i] = aw * bw - ax * bx - ay * by - az * bz;
+		}
+	}
+	static void quatNormalizeRange(const skQuatSoA& in, const skQuatSoA& out, size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			float x = in.x[i], y = in.y[i], z = in.z[i], w = in.w[i];
+			float inv = 1.0f / sqrtf(x * x + y * y + z * z + w * w);
+			out.x[i] = x * inv; out.y[i] = y * inv; out.z[i] = z * inv; out.w[i] = w * inv;
+		}
+	}
+	static void quatNlerpRange(const skQuatSoA& a, const skQuatSoA& b, const float* t, const skQuatSoA& out, size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			float d = a.x[i] * b.x[i] + a.y[i] * b.y[i] + a.z[i] * b.z[i] + a.w[i] * b.w[i];
+			float wb = d < 0.0f ? -t[i] : t[i];
+			float wa = 1.0f - t[i];
+			float x = wa * a.x[i] + wb * b.x[i], y = wa * a.y[i] + wb * b.y[i];
+			float z = wa * a.z[i] + wb * b.z[i], w = wa * a.w[i] + wb * b.w[i];
+			float inv = 1.0f / sqrtf(x * x + y * y + z * z + w * w);
+			out.x[i] = x * inv; out.y[i] = y * inv; out.z[i] = z * inv; out.w[i] = w * inv;
+		}
+	}
+	static void quatSlerpRange(const skQuatSoA& a, const skQuatSoA& b, const float* t, const skQuatSoA& out, size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			float d = a.x[i] * b.x[i] + a.y[i] * b.y[i] + a.z[i] * b.z[i] + a.w[i] * b.w[i];
+			float sign = d < 0.0f ? -1.0f : 1.0f;
+			d *= sign;
+			float wa, wb;
+			if (d > 0.9995f) {
+				wa = 1.0f - t[i];
+				wb = t[i];
+			}
+			else {
+				float theta = acosf(d);
+				float invSin = 1.0f / sinf(theta);
+				wa = sinf((1.0f - t[i]) * theta) * invSin;
+				wb = sinf(t[i] * theta) * invSin;
+			}
+			wb *= sign;
+			float x = wa * a.x[i] + wb * b.x[i], y = wa * a.y[i] + wb * b.y[i];
+			float z = wa * a.z[i] + wb * b.z[i], w = wa * a.w[i] + wb * b.w[i];
+			if (d > 0.9995f) {
+				float inv = 1.0f / sqrtf(x * x + y * y + z * z + w * w);
+				x *= inv; y *= inv; z *= inv; w *= inv;
+			}
+			out.x[i] = x; out.y[i] = y; out.z[i] = z; out.w[i] = w;
+		}
+	}
+	static void quatToMatRange(const skQuatSoA& in, float* out, size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			float r[9];
+			quatBasis(in.x[i], in.y[i], in.z[i], in.w[i], r);
+			writeTRS(out + i * 16, r, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f);
+		}
+	}
+	// Scalar Cephes sincos, same reduction and polynomials as the SIMD paths
+	static void sincos(float x, float* sOut, float* cOut) {
+		typedef skSinCosConst k;
+		float ax = fabsf(x);
+		int j = ((int)(ax * k::fourOverPi) + 1) & ~1;
+		float y = (float)j;
+		float r = ((ax + y * k::dp1) + y * k::dp2) + y * k::dp3;
+		float z = r * r;
+		float pc = ((k::cos0 * z + k::cos1) * z + k::cos2) * z * z - 0.5f * z + 1.0f;
+		float ps = ((k::sin0 * z + k::sin1) * z + k::sin2) * z * r + r;
+		bool swap = (j & 2) != 0;
+		float sv = swap ? pc : ps;
+		float cv = swap ? ps : pc;
+		*sOut = ((x < 0.0f) != ((j & 4) != 0)) ? -sv : sv;
+		*cOut = (((j - 2) & 4) == 0) ? -cv : cv;
+	}
+	static void sincosRange(const float* angle, float* sOut, float* cOut, size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			sincos(angle[i], sOut + i, cOut + i);
+		}
+	}
+	static void sincosBatch(const float* angle, float* sOut, float* cOut, size_t count) {
+		sincosRange(angle, sOut, cOut, 0, count);
+	}
+	// Zero length vectors stay zero
+	static void normalize3Range(float* x, float* y, float* z, size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			float len2 = x[i] * x[i] + y[i] * y[i] + z[i] * z[i];
+			float inv = len2 > 0.0f ? 1.0f / sqrtf(len2) : 0.0f;
+			x[i] *= inv; y[i] *= inv; z[i] *= inv;
+		}
+	}
+	static void normalize3Batch(float* x, float* y, float* z, size_t count) {
+		normalize3Range(x, y, z, 0, count);
+	}
+	// General inverse by 2x2 sub-determinants. Works on either storage order since
+	// inverse(transpose(m)) == transpose(inverse(m)). Singular input gives inf/nan like glm
+	template<class T>
+	static void inverse4(const T* e, T* out) {
+		T s0 = e[0] * e[5] - e[4] * e[1], s1 = e[0] * e[6] - e[4] * e[2], s2 = e[0] * e[7] - e[4] * e[3];
+		T s3 = e[1] * e[6] - e[5] * e[2], s4 = e[1] * e[7] - e[5] * e[3], s5 = e[2] * e[7] - e[6] * e[3];
+		T c5 = e[10] * e[15] - e[14] * e[11], c4 = e[9] * e[15] - e[13] * e[11], c3 = e[9] * e[14] - e[13] * e[10];
+		T c2 = e[8] * e[15] - e[12] * e[11], c1 = e[8] * e[14] - e[12] * e[10], c0 = e[8] * e[13] - e[12] * e[9];
+		T inv = 1 / (s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0);
+		T o[16] = {
+			(e[5] * c5 - e[6] * c4 + e[7] * c3) * inv, (-e[1] * c5 + e[2] * c4 - e[3] * c3) * inv,
+			(e[13] * s5 - e[14] * s4 + e[15] * s3) * inv, (-e[9] * s5 + e[10] * s4 - e[11] * s3) * inv,
+			(-e[4] * c5 + e[6] * c2 - e[7] * c1) * inv, (e[0] * c5 - e[2] * c2 + e[3] * c1) * inv,
+			(-e[12] * s5 + e[14] * s2 - e[15] * s1) * inv, (e[8] * s5 - e[10] * s2 + e[11] * s1) * inv,
+			(e[4] * c4 - e[5] * c2 + e[7] * c0) * inv, (-e[0] * c4 + e[1] * c2 - e[3] * c0) * inv,
+			(e[12] * s4 - e[13] * s2 + e[15] * s0) * inv, (-e[8] * s4 + e[9] * s2 - e[11] * s0) * inv,
+			(-e[4] * c3 + e[5] * c1 - e[6] * c0) * inv, (e[0] * c3 - e[1] * c1 + e[2] * c0) * inv,
+			(-e[12] * s3 + e[13] * s1 - e[14] * s0) * inv, (e[8] * s3 - e[9] * s1 + e[10] * s0) * inv
+		};
+		for (int i = 0; i < 16; i++) {
+			out[i] = o[i];
+		}
+	}
+	// Columns c0..c2 orthonormal within eps, i.e. rotation (+translation) only
+	template<class T>
+	static bool isRigid(const T* e, T eps) {
+		const T* c0 = e;
+		const T* c1 = e + 4;
+		const T* c2 = e + 8;
+		T d00 = c0[0] * c0[0] + c0[1] * c0[1] + c0[2] * c0[2] - 1;
+		T d11 = c1[0] * c1[0] + c1[1] * c1[1] + c1[2] * c1[2] - 1;
+		T d22 = c2[0] * c2[0] + c2[1] * c2[1] + c2[2] * c2[2] - 1;
+		T d01 = c0[0] * c1[0] + c0[1] * c1[1] + c0[2] * c1[2];
+		T d02 = c0[0] * c2[0] + c0[1] * c2[1] + c0[2] * c2[2];
+		T d12 = c1[0] * c2[0] + c1[1] * c2[1] + c1[2] * c2[2];
+		return d00 < eps && -d00 < eps && d11 < eps && -d11 < eps && d22 < eps && -d22 < eps
+			&& d01 < eps && -d01 < eps && d02 < eps && -d02 < eps && d12 < eps && -d12 < eps;
+	}
+	// Rows of the 3x3 inverse are the cross products of the columns over det
+	template<class T>
+	static void affineCofactors(const T* e, T r[9], T& det) {
+		const T* c0 = e;
+		const T* c1 = e + 4;
+		const T* c2 = e + 8;
+		r[0] = c1[1] * c2[2] - c1[2] * c2[1]; r[1] = c1[2] * c2[0] - c1[0] * c2[2]; r[2] = c1[0] * c2[1] - c1[1] * c2[0];
+		r[3] = c2[1] * c0[2] - c2[2] * c0[1]; r[4] = c2[2] * c0[0] - c2[0] * c0[2]; r[5] = c2[0] * c0[1] - c2[1] * c0[0];
+		r[6] = c0[1] * c1[2] - c0[2] * c1[1]; r[7] = c0[2] * c1[0] - c0[0] * c1[2]; r[8] = c0[0] * c1[1] - c0[1] * c1[0];
+		det = c0[0] * r[0] + c0[1] * r[1] + c0[2] * r[2];
+	}
+	// Inverse of a matrix whose bottom row is (0, 0, 0, 1); rigid input just transposes
+	template<class T>
+	static void affineInverse4(const T* e, T* out) {
+		T r[9];
+		if (isRigid(e, (T)1e-4)) {
+			r[0] = e[0]; r[1] = e[1]; r[2] = e[2];
+			r[3] = e[4]; r[4] = e[5]; r[5] = e[6];
+			r[6] = e[8]; r[7] = e[9]; r[8] = e[10];
+		}
+		else {
+			T det;
+			affineCofactors(e, r, det);
+			T inv = 1 / det;
+			for (int i = 0; i < 9; i++) {
+				r[i] *= inv;
+			}
+		}
+		T tx = e[12], ty = e[13], tz = e[14];
+		T o[16] = {
+			r[0], r[3], r[6], 0,
+			r[1], r[4], r[7], 0,
+			r[2], r[5], r[8], 0,
+			-(r[0] * tx + r[1] * ty + r[2] * tz), -(r[3] * tx + r[4] * ty + r[5] * tz), -(r[6] * tx + r[7] * ty + r[8] * tz), 1
+		};
+		for (int i = 0; i < 16; i++) {
+			out[i] = o[i];
+		}
+	}
+	// transpose(inverse(upper 3x3)) in the upper 3x3 of an otherwise identity matrix
+	template<class T>
+	static void normalMatrix4(const T* e, T* out) {
+		T r[9], det;
+		affineCofactors(e, r, det);
+		T inv = 1 / det;
+		T o[16] = {
+			r[0] * inv, r[1] * inv, r[2] * inv, 0,
+			r[3] * inv, r[4] * inv, r[5] * inv, 0,
+			r[6] * inv, r[7] * inv, r[8] * inv, 0,
+			0, 0, 0, 1
+		};
+		for (int i = 0; i < 16; i++) {
+			out[i] = o[i];
+		}
+	}
+	static void inverseRange(const float* in, float* out, size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			inverse4(in + i * 16, out + i * 16);
+		}
+	}
+	static void affineInverseRange(const float* in, float* out, size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			affineInverse4(in + i * 16, out + i * 16);
+		}
+	}
+	static void normalMatrixRange(const float* in, float* out, size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			normalMatrix4(in + i * 16, out + i * 16);
+		}
+	}
+	static void inverseBatch(const float* in, float* out, size_t count) {
+		inverseRange(in, out, 0, count);
+	}
+	static void affineInverseBatch(const float* in, float* out, size_t count) {
+		affineInverseRange(in, out, 0, count);
+	}
+	static void normalMatrixBatch(const float* in, float* out, size_t count) {
+		normalMatrixRange(in, out, 0, count);
+	}
+	static void quatMult(const skQuatSoA& a, const skQuatSoA& b, const skQuatSoA& out, size_t count) {
+		quatMultRange(a, b, out, 0, count);
+	}
+	static void quatNormalize(const skQuatSoA& in, const skQuatSoA& out, size_t count) {
+		quatNormalizeRange(in, out, 0, count);
+	}
+	static void quatNlerp(const skQuatSoA& a, const skQuatSoA& b, const float* t, const skQuatSoA& out, size_t count) {
+		quatNlerpRange(a, b, t, out, 0, count);
+	}
+	static void quatSlerp(const skQuatSoA& a, const skQuatSoA& b, const float* t, const skQuatSoA& out, size_t count) {
+		quatSlerpRange(a, b, t, out, 0, count);
+	}
+	static void quatToMat(const skQuatSoA& in, float* out, size_t count) {
+		quatToMatRange(in, out, 0, count);
+	}
+	// Culling planes are 6 x (nx, ny, nz, d) with the inside where dot(n, p) + d >= 0.
+	// visible[i] is set to 1 or 0, the return value is how many were visible
+	static size_t cullAabbRange(const float* planes, const skAabbSoA& soa, unsigned char* visible, size_t begin, size_t end) {
+		size_t n = 0;
+		for (size_t i = begin; i < end; i++) {
+			bool in = true;
+			for (int p = 0; p < 6 && in; p++) {
+				const float* pl = planes + p * 4;
+				float dist = pl[0] * soa.centerX[i] + pl[1] * soa.centerY[i] + pl[2] * soa.centerZ[i] + pl[3];
+				float r = std::fabs(pl[0]) * soa.extentX[i] + std::fabs(pl[1]) * soa.extentY[i] + std::fabs(pl[2]) * soa.extentZ[i];
+				in = dist + r >= 0.0f;
+			}
+			visible[i] = in ? 1 : 0;
+			n += in ? 1 : 0;
+		}
+		return n;
+	}
+	static size_t cullSphereRange(const float* planes, const skSphereSoA& soa, unsigned char* visible, size_t begin, size_t end) {
+		size_t n = 0;
+		for (size_t i = begin; i < end; i++) {
+			bool in = true;
+			for (int p = 0; p < 6 && in; p++) {
+				const float* pl = planes + p * 4;
+				in = pl[0] * soa.x[i] + pl[1] * soa.y[i] + pl[2] * soa.z[i] + pl[3] + soa.radius[i] >= 0.0f;
+			}
+			visible[i] = in ? 1 : 0;
+			n += in ? 1 : 0;
+		}
+		return n;
+	}
+	static size_t cullAabb(const float* planes, const skAabbSoA& soa, unsigned char* visible, size_t count) {
+		return cullAabbRange(planes, soa, visible, 0, count);
+	}
+	static size_t cullSphere(const float* planes, const skSphereSoA& soa, unsigned char* visible, size_t count) {
+		return cullSphereRange(planes, soa, visible, 0, count);
+	}
+	// IEEE half conversion with round to nearest even, the same result F16C gives.
+	// Overflow goes to infinity, NaN stays NaN (F16C keeps the payload, this does not).
+	// Bit tricks from Fabian Giesen
+	static uint16_t floatToHalf(float value) {
+		uint32_t u;
+		memcpy(&u, &value, 4);
+		uint32_t sign = u & 0x80000000u;
+		u ^= sign;
+		uint16_t h;
+		if (u >= 0x47800000u) {
+			h = u > 0x7f800000u ? 0x7e00 : 0x7c00;
+		}
+		else if (u < 0x38800000u) {
+			// subnormal or zero: let the FPU round by adding a magic number
+			float f, magic;
+			uint32_t magicBits = 0x3f000000u;
+			memcpy(&f, &u, 4);
+			memcpy(&magic, &magicBits, 4);
+			f += magic;
+			memcpy(&u, &f, 4);
+			h = (uint16_t)(u - magicBits);
+		}
+		else {
+			uint32_t mantOdd = (u >> 13) & 1;
+			u += 0xc8000fffu + mantOdd;
+			h = (uint16_t)(u >> 13);
+		}
+		return (uint16_t)(h | (sign >> 16));
+	}
+	static float halfToFloat(uint16_t half) {
+		uint32_t u = (uint32_t)(half & 0x7fff) << 13;
+		uint32_t exp = u & 0x0f800000u;
+		u += 0x38000000u;
+		if (exp == 0x0f800000u) {
+			u += 0x38000000u;
+		}
+		else if (exp == 0) {
+			float f, magic;
+			uint32_t magicBits = 0x38800000u;
+			u += 0x00800000u;
+			memcpy(&f, &u, 4);
+			memcpy(&magic, &magicBits, 4);
+			f -= magic;
+			memcpy(&u, &f, 4);
+		}
+		u |= (uint32_t)(half & 0x8000) << 16;
+		float f;
+		memcpy(&f, &u, 4);
+		return f;
+	}
+	// Normalized integers as GL reads them back: snorm c / 32767, unorm c / 65535 or c / 255.
+	// Input is clamped, rounding is to nearest even like the SIMD conversions
+	static int16_t packSnorm16(float value) {
+		float c = value < -1.0f ? -1.0f : (value > 1.0f ? 1.0f : value);
+		return (int16_t)std::lrint(c * 32767.0f);
+	}
+	static uint16_t packUnorm16(float value) {
+		float c = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+		return (uint16_t)std::lrint(c * 65535.0f);
+	}
+	static uint8_t packUnorm8(float value) {
+		float c = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+		return (uint8_t)std::lrint(c * 255.0f);
+	}
+	// Octahedral unit vector encoding (Cigolle et al. 2014): project onto the octahedron,
+	// fold the lower half over the diagonals. Two snorm16 are within 0.05 degrees
+	static void octEncode(float x, float y, float z, int16_t out[2]) {
+		float l1 = std::fabs(x) + std::fabs(y) + std::fabs(z);
+		float inv = l1 > 0.0f ? 1.0f / l1 : 0.0f;
+		float u = x * inv, v = y * inv;
+		if (z < 0.0f) {
+			float fu = (1.0f - std::fabs(v)) * (u >= 0.0f ? 1.0f : -1.0f);
+			float fv = (1.0f - std::fabs(u)) * (v >= 0.0f ? 1.0f : -1.0f);
+			u = fu;
+			v = fv;
+		}
+		out[0] = packSnorm16(u);
+		out[1] = packSnorm16(v);
+	}
+	static void floatToHalfRange(const float* in, uint16_t* out, size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			out[i] = floatToHalf(in[i]);
+		}
+	}
+	static void halfToFloatRange(const uint16_t* in, float* out, size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			out[i] = halfToFloat(in[i]);
+		}
+	}
+	static void packSnorm16Range(const float* in, int16_t* out, size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			out[i] = packSnorm16(in[i]);
+		}
+	}
+	static void packUnorm16Range(const float* in, uint16_t* out, size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			out[i] = packUnorm16(in[i]);
+		}
+	}
+	static void packUnorm8Range(const float* in, uint8_t* out, size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			out[i] = packUnorm8(in[i]);
+		}
+	}
+	static void octEncodeRange(const float* x, const float* y, const float* z, int16_t* out, size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			octEncode(x[i], y[i], z[i], out + i * 2);
+		}
+	}
+	static void floatToHalfBatch(const float* in, uint16_t* out, size_t count) {
+		floatToHalfRange(in, out, 0, count);
+	}
+	static void halfToFloatBatch(const uint16_t* in, float* out, size_t count) {
+		halfToFloatRange(in, out, 0, count);
+	}
+	static void packSnorm16Batch(const float* in, int16_t* out, size_t count) {
+		packSnorm16Range(in, out, 0, count);
+	}
+	static void packUnorm16Batch(const float* in, uint16_t* out, size_t count) {
+		packUnorm16Range(in, out, 0, count);
+	}
+	static void packUnorm8Batch(const float* in, uint8_t* out, size_t count) {
+		packUnorm8Range(in, out, 0, count);
+	}
+	static void octEncodeBatch(const float* x, const float* y, const float* z, int16_t* out, size_t count) {
+		octEncodeRange(x, y, z, out, 0, count);
+	}
+};
+
+#ifdef SK_SIMD_X86
+struct skSse41Kernels {
+	SK_TARGET_SSE41 static void multMat4(const float* a, const float* b, float* out) {
+		__m128 b0 = _mm_loadu_ps(b + 0);
+		__m128 b1 = _mm_loadu_ps(b + 4);
+		__m128 b2 = _mm_loadu_ps(b + 8);
+		__m128 b3 = _mm_loadu_ps(b + 12);
+		__m128 r[4];
+		for (int i = 0; i < 4; i++) {
+			__m128 row = _mm_mul_ps(_mm_set1_ps(a[i * 4 + 0]), b0);
+			row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a[i * 4 + 1]), b1));
+			row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a[i * 4 + 2]), b2));
+			row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a[i * 4 + 3]), b3));
+			r[i] = row;
+		}
+		// store last so out may alias a or b
+		for (int i = 0; i < 4; i++) {
+			_mm_storeu_ps(out + i * 4, r[i]);
+		}
+	}
+	SK_TARGET_SSE41 static void multMat4Batch(const float* a, const float* b, float* out, size_t count) {
+		for (size_t n = 0; n < count; n++) {
+			multMat4(a + n * 16, b + n * 16, out + n * 16);
+		}
+	}
+	SK_TARGET_SSE41 static void addMat4(const float* a, const float* b, float* out) {
+		for (int i = 0; i < 16; i += 4) {
+			_mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+		}
+	}
+	SK_TARGET_SSE41 static void multVect4(const float* m, const float* v, float* out) {
+		__m128 r = _mm_mul_ps(_mm_set1_ps(v[0]), _mm_loadu_ps(m + 0));
+		r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(v[1]), _mm_loadu_ps(m + 4)));
+		r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(v[2]), _mm_loadu_ps(m + 8)));
+		r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(v[3]), _mm_loadu_ps(m + 12)));
+		_mm_storeu_ps(out, r);
+	}
+	SK_TARGET_SSE41 static void multVect4Batch(const float* m, const float* v, float* out, size_t count) {
+		__m128 m0 = _mm_loadu_ps(m + 0);
+		__m128 m1 = _mm_loadu_ps(m + 4);
+		__m128 m2 = _mm_loadu_ps(m + 8);
+		__m128 m3 = _mm_loadu_ps(m + 12);
+		for (size_t n = 0; n < count; n++) {
+			const float* in = v + n * 4;
+			__m128 r = _mm_mul_ps(_mm_set1_ps(in[0]), m0);
+			r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(in[1]), m1));
+			r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(in[2]), m2));
+			r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(in[3]), m3));
+			_mm_storeu_ps(out + n * 4, r);
+		}
+	}
+	// Four lanes at once, accurate to a couple of ulp for |x| < 8192
+	SK_TARGET_SSE41 static void sincos(__m128 x, __m128* sOut, __m128* cOut) {
+		typedef skSinCosConst k;
+		const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32((int)0x80000000));
+		__m128 sinSign = _mm_and_ps(x, signMask);
+		x = _mm_andnot_ps(signMask, x);
+		__m128i j = _mm_cvttps_epi32(_mm_mul_ps(x, _mm_set1_ps(k::fourOverPi)));
+		j = _mm_and_si128(_mm_add_epi32(j, _mm_set1_epi32(1)), _mm_set1_epi32(~1));
+		__m128 y = _mm_cvtepi32_ps(j);
+		__m128 sinFlip = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(j, _mm_set1_epi32(4)), 29));
+		__m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_andnot_si128(_mm_sub_epi32(j, _mm_set1_epi32(2)), _mm_set1_epi32(4)), 29));
+		__m128 polyMask = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(j, _mm_set1_epi32(2)), _mm_setzero_si128()));
+		x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(k::dp1)));
+		x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(k::dp2)));
+		x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(k::dp3)));
+		__m128 z = _mm_mul_ps(x, x);
+		__m128 pc = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(k::cos0), z), _mm_set1_ps(k::cos1));
+		pc = _mm_add_ps(_mm_mul_ps(pc, z), _mm_set1_ps(k::cos2));
+		pc = _mm_mul_ps(_mm_mul_ps(pc, z), z);
+		pc = _mm_add_ps(_mm_sub_ps(pc, _mm_mul_ps(z, _mm_set1_ps(0.5f))), _mm_set1_ps(1.0f));
+		__m128 ps = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(k::sin0), z), _mm_set1_ps(k::sin1));
+		ps = _mm_add_ps(_mm_mul_ps(ps, z), _mm_set1_ps(k::sin2));
+		ps = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(ps, z), x), x);
+		*sOut = _mm_xor_ps(_mm_blendv_ps(pc, ps, polyMask), _mm_xor_ps(sinSign, sinFlip));
+		*cOut = _mm_xor_ps(_mm_blendv_ps(ps, pc, polyMask), cosSign);
+	}
+	SK_TARGET_SSE41 static void sincosBatch(const float* angle, float* sOut, float* cOut, size_t count) {
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			__m128 sv, cv;
+			sincos(_mm_loadu_ps(angle + i), &sv, &cv);
+			_mm_storeu_ps(sOut + i, sv);
+			_mm_storeu_ps(cOut + i, cv);
+		}
+		skScalarKernels::sincosRange(angle, sOut, cOut, i, count);
+	}
+	// rsqrtps is good to 12 bits, one Newton step brings it to about 22
+	SK_TARGET_SSE41 static __m128 rsqrtNewton(__m128 x) {
+		__m128 r = _mm_rsqrt_ps(x);
+		__m128 halfXrr = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), x), _mm_mul_ps(r, r));
+		return _mm_mul_ps(r, _mm_sub_ps(_mm_set1_ps(1.5f), halfXrr));
+	}
+	SK_TARGET_SSE41 static void normalize3Batch(float* x, float* y, float* z, size_t count) {
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			__m128 vx = _mm_loadu_ps(x + i), vy = _mm_loadu_ps(y + i), vz = _mm_loadu_ps(z + i);
+			__m128 len2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz));
+			__m128 inv = _mm_and_ps(_mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(len2)), _mm_cmpgt_ps(len2, _mm_setzero_ps()));
+			_mm_storeu_ps(x + i, _mm_mul_ps(vx, inv));
+			_mm_storeu_ps(y + i, _mm_mul_ps(vy, inv));
+			_mm_storeu_ps(z + i, _mm_mul_ps(vz, inv));
+		}
+		skScalarKernels::normalize3Range(x, y, z, i, count);
+	}
+	SK_TARGET_SSE41 static void normalize3FastBatch(float* x, float* y, float* z, size_t count) {
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			__m128 vx = _mm_loadu_ps(x + i), vy = _mm_loadu_ps(y + i), vz = _mm_loadu_ps(z + i);
+			__m128 len2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz));
+			__m128 inv = _mm_and_ps(rsqrtNewton(len2), _mm_cmpgt_ps(len2, _mm_setzero_ps()));
+			_mm_storeu_ps(x + i, _mm_mul_ps(vx, inv));
+			_mm_storeu_ps(y + i, _mm_mul_ps(vy, inv));
+			_mm_storeu_ps(z + i, _mm_mul_ps(vz, inv));
+		}
+		skScalarKernels::normalize3Range(x, y, z, i, count);
+	}
+	// Inverse of storeMatrices: e[k] gets element k of 4 consecutive matrices
+	SK_TARGET_SSE41 static void loadMatrices(const float* in, __m128 e[16]) {
+		for (int g = 0; g < 4; g++) {
+			__m128 r0 = _mm_loadu_ps(in + 0 * 16 + g * 4), r1 = _mm_loadu_ps(in + 1 * 16 + g * 4);
+			__m128 r2 = _mm_loadu_ps(in + 2 * 16 + g * 4), r3 = _mm_loadu_ps(in + 3 * 16 + g * 4);
+			_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+			e[g * 4 + 0] = r0;
+			e[g * 4 + 1] = r1;
+			e[g * 4 + 2] = r2;
+			e[g * 4 + 3] = r3;
+		}
+	}
+	SK_TARGET_SSE41 static __m128 fms(__m128 a, __m128 b, __m128 c, __m128 d) {
+		return _mm_sub_ps(_mm_mul_ps(a, b), _mm_mul_ps(c, d));
+	}
+	SK_TARGET_SSE41 static __m128 sum3(__m128 a, __m128 b, __m128 c, __m128 d, __m128 e, __m128 f) {
+		return _mm_add_ps(_mm_sub_ps(_mm_mul_ps(a, b), _mm_mul_ps(c, d)), _mm_mul_ps(e, f));
+	}
+	SK_TARGET_SSE41 static void inverseBatch(const float* in, float* out, size_t count) {
+		size_t i = 0;
+		const __m128 one = _mm_set1_ps(1.0f);
+		for (; i + 4 <= count; i += 4) {
+			__m128 e[16];
+			loadMatrices(in + i * 16, e);
+			__m128 s0 = fms(e[0], e[5], e[4], e[1]), s1 = fms(e[0], e[6], e[4], e[2]), s2 = fms(e[0], e[7], e[4], e[3]);
+			__m128 s3 = fms(e[1], e[6], e[5], e[2]), s4 = fms(e[1], e[7], e[5], e[3]), s5 = fms(e[2], e[7], e[6], e[3]);
+			__m128 c5 = fms(e[10], e[15], e[14], e[11]), c4 = fms(e[9], e[15], e[13], e[11]), c3 = fms(e[9], e[14], e[13], e[10]);
+			__m128 c2 = fms(e[8], e[15], e[12], e[11]), c1 = fms(e[8], e[14], e[12], e[10]), c0 = fms(e[8], e[13], e[12], e[9]);
+			__m128 det = _mm_add_ps(_mm_add_ps(fms(s0, c5, s1, c4), fms(s2, c3, _mm_xor_ps(_mm_set1_ps(-0.0f), s3), c2)), fms(s5, c0, s4, c1));
+			__m128 inv = _mm_div_ps(one, det);
+			__m128 o[16] = {
+				sum3(e[5], c5, e[6], c4, e[7], c3), sum3(e[2], c4, e[1], c5, _mm_xor_ps(_mm_set1_ps(-0.0f), e[3]), c3),
+				sum3(e[13], s5, e[14], s4, e[15], s3), sum3(e[10], s4, e[9], s5, _mm_xor_ps(_mm_set1_ps(-0.0f), e[11]), s3),
+				sum3(e[6], c2, e[4], c5, _mm_xor_ps(_mm_set1_ps(-0.0f), e[7]), c1), sum3(e[0], c5, e[2], c2, e[3], c1),
+				sum3(e[14], s2, e[12], s5, _mm_xor_ps(_mm_set1_ps(-0.0f), e[15]), s1), sum3(e[8], s5, e[10], s2, e[11], s1),
+				sum3(e[4], c4, e[5], c2, e[7], c0), sum3(e[1], c2, e[0], c4, _mm_xor_ps(_mm_set1_ps(-0.0f), e[3]), c0),
+				sum3(e[12], s4, e[13], s2, e[15], s0), sum3(e[9], s2, e[8], s4, _mm_xor_ps(_mm_set1_ps(-0.0f), e[11]), s0),
+				sum3(e[5], c1, e[4], c3, _mm_xor_ps(_mm_set1_ps(-0.0f), e[6]), c0), sum3(e[0], c3, e[1], c1, e[2], c0),
+				sum3(e[13], s1, e[12], s3, _mm_xor_ps(_mm_set1_ps(-0.0f), e[14]), s0), sum3(e[8], s3, e[9], s1, e[10], s0)
+			};
+			for (int k = 0; k < 16; k++) {
+				o[k] = _mm_mul_ps(o[k], inv);
+			}
+			storeMatrices(o, out + i * 16);
+		}
+		skScalarKernels::inverseRange(in, out, i, count);
+	}
+	// Cross products of the basis columns; row r of the 3x3 inverse is r[3r..3r+2] / det
+	SK_TARGET_SSE41 static __m128 affineCofactors(const __m128 e[16], __m128 r[9]) {
+		r[0] = fms(e[5], e[10], e[6], e[9]); r[1] = fms(e[6], e[8], e[4], e[10]); r[2] = fms(e[4], e[9], e[5], e[8]);
+		r[3] = fms(e[9], e[2], e[10], e[1]); r[4] = fms(e[10], e[0], e[8], e[2]); r[5] = fms(e[8], e[1], e[9], e[0]);
+		r[6] = fms(e[1], e[6], e[2], e[5]); r[7] = fms(e[2], e[4], e[0], e[6]); r[8] = fms(e[0], e[5], e[1], e[4]);
+		return _mm_add_ps(_mm_add_ps(_mm_mul_ps(e[0], r[0]), _mm_mul_ps(e[1], r[1])), _mm_mul_ps(e[2], r[2]));
+	}
+	SK_TARGET_SSE41 static __m128 nearZero(__m128 x, __m128 eps) {
+		return _mm_cmplt_ps(_mm_andnot_ps(_mm_set1_ps(-0.0f), x), eps);
+	}
+	// All lanes rigid? Then the transpose replaces the cofactors and the divide
+	SK_TARGET_SSE41 static bool allRigid(const __m128 e[16]) {
+		const __m128 eps = _mm_set1_ps(1e-4f), one = _mm_set1_ps(1.0f);
+		__m128 m = nearZero(_mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e[0], e[0]), _mm_mul_ps(e[1], e[1])), _mm_mul_ps(e[2], e[2])), one), eps);
+		m = _mm_and_ps(m, nearZero(_mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e[4], e[4]), _mm_mul_ps(e[5], e[5])), _mm_mul_ps(e[6], e[6])), one), eps));
+		m = _mm_and_ps(m, nearZero(_mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e[8], e[8]), _mm_mul_ps(e[9], e[9])), _mm_mul_ps(e[10], e[10])), one), eps));
+		m = _mm_and_ps(m, nearZero(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e[0], e[4]), _mm_mul_ps(e[1], e[5])), _mm_mul_ps(e[2], e[6])), eps));
+		m = _mm_and_ps(m, nearZero(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e[0], e[8]), _mm_mul_ps(e[1], e[9])), _mm_mul_ps(e[2], e[10])), eps));
+		m = _mm_and_ps(m, nearZero(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e[4], e[8]), _mm_mul_ps(e[5], e[9])), _mm_mul_ps(e[6], e[10])), eps));
+		return _mm_movemask_ps(m) == 0xF;
+	}
+	SK_TARGET_SSE41 static void affineInverseBatch(const float* in, float* out, size_t count) {
+		size_t i = 0;
+		const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+		for (; i + 4 <= count; i += 4) {
+			__m128 e[16], r[9];
+			loadMatrices(in + i * 16, e);
+			if (allRigid(e)) {
+				r[0] = e[0]; r[1] = e[1]; r[2] = e[2];
+				r[3] = e[4]; r[4] = e[5]; r[5] = e[6];
+				r[6] = e[8]; r[7] = e[9]; r[8] = e[10];
+			}
+			else {
+				__m128 inv = _mm_div_ps(one, affineCofactors(e, r));
+				for (int k = 0; k < 9; k++) {
+					r[k] = _mm_mul_ps(r[k], inv);
+				}
+			}
+			__m128 tx = e[12], ty = e[13], tz = e[14];
+			__m128 o[16] = {
+				r[0], r[3], r[6], zero,
+				r[1], r[4], r[7], zero,
+				r[2], r[5], r[8], zero,
+				_mm_xor_ps(_mm_set1_ps(-0.0f), _mm_add_ps(_mm_add_ps(_mm_mul_ps(r[0], tx), _mm_mul_ps(r[1], ty)), _mm_mul_ps(r[2], tz))),
+				_mm_xor_ps(_mm_set1_ps(-0.0f), _mm_add_ps(_mm_add_ps(_mm_mul_ps(r[3], tx), _mm_mul_ps(r[4], ty)), _mm_mul_ps(r[5], tz))),
+				_mm_xor_ps(_mm_set1_ps(-0.0f), _mm_add_ps(_mm_add_ps(_mm_mul_ps(r[6], tx), _mm_mul_ps(r[7], ty)), _mm_mul_ps(r[8], tz))), one
+			};
+			storeMatrices(o, out + i * 16);
+		}
+		skScalarKernels::affineInverseRange(in, out, i, count);
+	}
+	SK_TARGET_SSE41 static void normalMatrixBatch(const float* in, float* out, size_t count) {
+		size_t i = 0;
+		const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+		for (; i + 4 <= count; i += 4) {
+			__m128 e[16], r[9];
+			loadMatrices(in + i * 16, e);
+			__m128 inv = _mm_div_ps(one, affineCofactors(e, r));
+			__m128 o[16] = {
+				_mm_mul_ps(r[0], inv), _mm_mul_ps(r[1], inv), _mm_mul_ps(r[2], inv), zero,
+				_mm_mul_ps(r[3], inv), _mm_mul_ps(r[4], inv), _mm_mul_ps(r[5], inv), zero,
+				_mm_mul_ps(r[6], inv), _mm_mul_ps(r[7], inv), _mm_mul_ps(r[8], inv), zero,
+				zero, zero, zero, one
+			};
+			storeMatrices(o, out + i * 16);
+		}
+		skScalarKernels::normalMatrixRange(in, out, i, count);
+	}
+	SK_TARGET_SSE41 static __m128 loadOrOne(const float* p, size_t i) {
+		return p ? _mm_loadu_ps(p + i) : _mm_set1_ps(1.0f);
+	}
+	// e[0..15] hold matrix element k for four instances, write them out as four matrices
+	SK_TARGET_SSE41 static void storeMatrices(__m128 e[16], float* out) {
+		for (int g = 0; g < 4; g++) {
+			__m128 r0 = e[g * 4 + 0], r1 = e[g * 4 + 1], r2 = e[g * 4 + 2], r3 = e[g * 4 + 3];
+			_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+			_mm_storeu_ps(out + 0 * 16 + g * 4, r0);
+			_mm_storeu_ps(out + 1 * 16 + g * 4, r1);
+			_mm_storeu_ps(out + 2 * 16 + g * 4, r2);
+			_mm_storeu_ps(out + 3 * 16 + g * 4, r3);
+		}
+	}
+	SK_TARGET_SSE41 static void storeTRS(const skTransformSoA& soa, size_t i, __m128 r[9], float* out) {
+		__m128 sx = loadOrOne(soa.scaleX, i), sy = loadOrOne(soa.scaleY, i), sz = loadOrOne(soa.scaleZ, i);
+		__m128 zero = _mm_setzero_ps();
+		__m128 e[16] = {
+			_mm_mul_ps(r[0], sx), _mm_mul_ps(r[1], sx), _mm_mul_ps(r[2], sx), zero,
+			_mm_mul_ps(r[3], sy), _mm_mul_ps(r[4], sy), _mm_mul_ps(r[5], sy), zero,
+			_mm_mul_ps(r[6], sz), _mm_mul_ps(r[7], sz), _mm_mul_ps(r[8], sz), zero,
+			_mm_loadu_ps(soa.posX + i), _mm_loadu_ps(soa.posY + i), _mm_loadu_ps(soa.posZ + i), _mm_set1_ps(1.0f)
+		};
+		storeMatrices(e, out + i * 16);
+	}
+	SK_TARGET_SSE41 static void composeAxisAngle(const skTransformSoA& soa, float* out, size_t count) {
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			__m128 x = _mm_loadu_ps(soa.axisX + i), y = _mm_loadu_ps(soa.axisY + i), z = _mm_loadu_ps(soa.axisZ + i);
+			__m128 inv = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z))));
+			x = _mm_mul_ps(x, inv); y = _mm_mul_ps(y, inv); z = _mm_mul_ps(z, inv);
+			__m128 s, c;
+			sincos(_mm_loadu_ps(soa.angle + i), &s, &c);
+			__m128 t = _mm_sub_ps(_mm_set1_ps(1.0f), c);
+			__m128 tx = _mm_mul_ps(t, x), ty = _mm_mul_ps(t, y), tz = _mm_mul_ps(t, z);
+			__m128 sx = _mm_mul_ps(s, x), sy = _mm_mul_ps(s, y), sz = _mm_mul_ps(s, z);
+			__m128 txy = _mm_mul_ps(tx, y), txz = _mm_mul_ps(tx, z), tyz = _mm_mul_ps(ty, z);
+			__m128 r[9] = {
+				_mm_add_ps(_mm_mul_ps(tx, x), c), _mm_add_ps(txy, sz), _mm_sub_ps(txz, sy),
+				_mm_sub_ps(txy, sz), _mm_add_ps(_mm_mul_ps(ty, y), c), _mm_add_ps(tyz, sx),
+				_mm_add_ps(txz, sy), _mm_sub_ps(tyz, sx), _mm_add_ps(_mm_mul_ps(tz, z), c)
+			};
+			storeTRS(soa, i, r, out);
+		}
+		skScalarKernels::composeAxisAngleRange(soa, out, i, count);
+	}
+	SK_TARGET_SSE41 static void quatBasis(__m128 x, __m128 y, __m128 z, __m128 w, __m128 r[9]) {
+		const __m128 one = _mm_set1_ps(1.0f), two = _mm_set1_ps(2.0f);
+		__m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+		__m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+		__m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+		r[0] = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz)));
+		r[1] = _mm_mul_ps(two, _mm_add_ps(xy, wz));
+		r[2] = _mm_mul_ps(two, _mm_sub_ps(xz, wy));
+		r[3] = _mm_mul_ps(two, _mm_sub_ps(xy, wz));
+		r[4] = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz)));
+		r[5] = _mm_mul_ps(two, _mm_add_ps(yz, wx));
+		r[6] = _mm_mul_ps(two, _mm_add_ps(xz, wy));
+		r[7] = _mm_mul_ps(two, _mm_sub_ps(yz, wx));
+		r[8] = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy)));
+	}
+	SK_TARGET_SSE41 static void composeQuat(const skTransformSoA& soa, float* out, size_t count) {
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			__m128 r[9];
+			quatBasis(_mm_loadu_ps(soa.quatX + i), _mm_loadu_ps(soa.quatY + i), _mm_loadu_ps(soa.quatZ + i), _mm_loadu_ps(soa.quatW + i), r);
+			storeTRS(soa, i, r, out);
+		}
+		skScalarKernels::composeQuatRange(soa, out, i, count);
+	}
+	SK_TARGET_SSE41 static __m128 dot4(__m128 ax, __m128 ay, __m128 az, __m128 aw, __m128 bx, __m128 by, __m128 bz, __m128 bw) {
+		return _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_add_ps(_mm_mul_ps(az, bz), _mm_mul_ps(aw, bw)));
+	}
+	SK_TARGET_SSE41 static void storeNormalized(const skQuatSoA& out, size_t i, __m128 x, __m128 y, __m128 z, __m128 w) {
+		__m128 inv = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(dot4(x, y, z, w, x, y, z, w)));
+		_mm_storeu_ps(out.x + i, _mm_mul_ps(x, inv));
+		_mm_storeu_ps(out.y + i, _mm_mul_ps(y, inv));
+		_mm_storeu_ps(out.z + i, _mm_mul_ps(z, inv));
+		_mm_storeu_ps(out.w + i, _mm_mul_ps(w, inv));
+	}
+	SK_TARGET_SSE41 static void quatMult(const skQuatSoA& a, const skQuatSoA& b, const skQuatSoA& out, size_t count) {
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			__m128 ax = _mm_loadu_ps(a.x + i), ay = _mm_loadu_ps(a.y + i), az = _mm_loadu_ps(a.z + i), aw = _mm_loadu_ps(a.w + i);
+			__m128 bx = _mm_loadu_ps(b.x + i), by = _mm_loadu_ps(b.y + i), bz = _mm_loadu_ps(b.z + i), bw = _mm_loadu_ps(b.w + i);
+			__m128 x = _mm_add_ps(_mm_add_ps(_mm_mul_ps(aw, bx), _mm_mul_ps(ax, bw)), _mm_sub_ps(_mm_mul_ps(ay, bz), _mm_mul_ps(az, by)));
+			__m128 y = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(aw, by), _mm_mul_ps(ax, bz)), _mm_add_ps(_mm_mul_ps(ay, bw), _mm_mul_ps(az, bx)));
+			__m128 z = _mm_add_ps(_mm_add_ps(_mm_mul_ps(aw, bz), _mm_mul_ps(ax, by)), _mm_sub_ps(_mm_mul_ps(az, bw), _mm_mul_ps(ay, bx)));
+			__m128 w = _mm_sub_ps(_mm_mul_ps(aw, bw), _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_mul_ps(az, bz)));
+			_mm_storeu_ps(out.x + i, x);
+			_mm_storeu_ps(out.y + i, y);
+			_mm_storeu_ps(out.z + i, z);
+			_mm_storeu_ps(out.w + i, w);
+		}
+		skScalarKernels::quatMultRange(a, b, out, i, count);
+	}
+	SK_TARGET_SSE41 static void quatNormalize(const skQuatSoA& in, const skQuatSoA& out, size_t count) {
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			storeNormalized(out, i, _mm_loadu_ps(in.x + i), _mm_loadu_ps(in.y + i), _mm_loadu_ps(in.z + i), _mm_loadu_ps(in.w + i));
+		}
+		skScalarKernels::quatNormalizeRange(in, out, i, count);
+	}
+	SK_TARGET_SSE41 static void quatNlerp(const skQuatSoA& a, const skQuatSoA& b, const float* t, const skQuatSoA& out, size_t count) {
+		const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32((int)0x80000000));
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			__m128 ax = _mm_loadu_ps(a.x + i), ay = _mm_loadu_ps(a.y + i), az = _mm_loadu_ps(a.z + i), aw = _mm_loadu_ps(a.w + i);
+			__m128 bx = _mm_loadu_ps(b.x + i), by = _mm_loadu_ps(b.y + i), bz = _mm_loadu_ps(b.z + i), bw = _mm_loadu_ps(b.w + i);
+			__m128 tt = _mm_loadu_ps(t + i);
+			// flip the b weight when the quaternions sit in opposite hemispheres
+			__m128 wb = _mm_xor_ps(tt, _mm_and_ps(dot4(ax, ay, az, aw, bx, by, bz, bw), signMask));
+			__m128 wa = _mm_sub_ps(_mm_set1_ps(1.0f), tt);
+			storeNormalized(out, i,
+				_mm_add_ps(_mm_mul_ps(wa, ax), _mm_mul_ps(wb, bx)), _mm_add_ps(_mm_mul_ps(wa, ay), _mm_mul_ps(wb, by)),
+				_mm_add_ps(_mm_mul_ps(wa, az), _mm_mul_ps(wb, bz)), _mm_add_ps(_mm_mul_ps(wa, aw), _mm_mul_ps(wb, bw)));
+		}
+		skScalarKernels::quatNlerpRange(a, b, t, out, i, count);
+	}
+	// Eberly series for sin(t * theta) / sin(theta) given x = cos(theta)
+	SK_TARGET_SSE41 static __m128 slerpWeight(__m128 t, __m128 xm1, const __m128 u[8], const __m128 v[8]) {
+		__m128 t2 = _mm_mul_ps(t, t);
+		__m128 f = _mm_set1_ps(1.0f);
+		for (int k = 7; k >= 0; k--) {
+			__m128 bk = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(u[k], t2), v[k]), xm1);
+			f = _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(bk, f));
+		}
+		return _mm_mul_ps(t, f);
+	}
+	SK_TARGET_SSE41 static void quatSlerp(const skQuatSoA& a, const skQuatSoA& b, const float* t, const skQuatSoA& out, size_t count) {
+		const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32((int)0x80000000));
+		__m128 u[8], v[8];
+		for (int k = 0; k < 8; k++) {
+			u[k] = _mm_set1_ps(skSlerpConst::u(k));
+			v[k] = _mm_set1_ps(skSlerpConst::v(k));
+		}
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			__m128 ax = _mm_loadu_ps(a.x + i), ay = _mm_loadu_ps(a.y + i), az = _mm_loadu_ps(a.z + i), aw = _mm_loadu_ps(a.w + i);
+			__m128 bx = _mm_loadu_ps(b.x + i), by = _mm_loadu_ps(b.y + i), bz = _mm_loadu_ps(b.z + i), bw = _mm_loadu_ps(b.w + i);
+			__m128 tt = _mm_loadu_ps(t + i);
+			__m128 d = dot4(ax, ay, az, aw, bx, by, bz, bw);
+			__m128 sign = _mm_and_ps(d, signMask);
+			__m128 xm1 = _mm_sub_ps(_mm_xor_ps(d, sign), _mm_set1_ps(1.0f));
+			__m128 wa = slerpWeight(_mm_sub_ps(_mm_set1_ps(1.0f), tt), xm1, u, v);
+			__m128 wb = _mm_xor_ps(slerpWeight(tt, xm1, u, v), sign);
+			_mm_storeu_ps(out.x + i, _mm_add_ps(_mm_mul_ps(wa, ax), _mm_mul_ps(wb, bx)));
+			_mm_storeu_ps(out.y + i, _mm_add_ps(_mm_mul_ps(wa, ay), _mm_mul_ps(wb, by)));
+			_mm_storeu_ps(out.z + i, _mm_add_ps(_mm_mul_ps(wa, az), _mm_mul_ps(wb, bz)));
+			_mm_storeu_ps(out.w + i, _mm_add_ps(_mm_mul_ps(wa, aw), _mm_mul_ps(wb, bw)));
+		}
+		skScalarKernels::quatSlerpRange(a, b, t, out, i, count);
+	}
+	SK_TARGET_SSE41 static void quatToMat(const skQuatSoA& in, float* out, size_t count) {
+		size_t i = 0;
+		const __m128 zero = _mm_setzero_ps();
+		for (; i + 4 <= count; i += 4) {
+			__m128 r[9];
+			quatBasis(_mm_loadu_ps(in.x + i), _mm_loadu_ps(in.y + i), _mm_loadu_ps(in.z + i), _mm_loadu_ps(in.w + i), r);
+			__m128 e[16] = {
+				r[0], r[1], r[2], zero,
+				r[3], r[4], r[5], zero,
+				r[6], r[7], r[8], zero,
+				zero, zero, zero, _mm_set1_ps(1.0f)
+			};
+			storeMatrices(e, out + i * 16);
+		}
+		skScalarKernels::quatToMatRange(in, out, i, count);
+	}
+	// Unpacks a lane mask into visible[i..i+lanes) and returns how many lanes were set
+	static size_t storeVisible(int mask, int lanes, unsigned char* visible) {
+		size_t n = 0;
+		for (int j = 0; j < lanes; j++) {
+			unsigned char bit = (unsigned char)((mask >> j) & 1);
+			visible[j] = bit;
+			n += bit;
+		}
+		return n;
+	}
+	// 4 volumes against all 6 planes per iteration, plane terms broadcast once up front
+	SK_TARGET_SSE41 static size_t cullAabb(const float* planes, const skAabbSoA& soa, unsigned char* visible, size_t count) {
+		__m128 pl[24], apl[18];
+		__m128 signMask = _mm_set1_ps(-0.0f);
+		for (int p = 0; p < 6; p++) {
+			for (int c = 0; c < 4; c++) {
+				pl[p * 4 + c] = _mm_set1_ps(planes[p * 4 + c]);
+			}
+			for (int c = 0; c < 3; c++) {
+				apl[p * 3 + c] = _mm_andnot_ps(signMask, pl[p * 4 + c]);
+			}
+		}
+		size_t n = 0, i = 0;
+		for (; i + 4 <= count; i += 4) {
+			__m128 cx = _mm_loadu_ps(soa.centerX + i), cy = _mm_loadu_ps(soa.centerY + i), cz = _mm_loadu_ps(soa.centerZ + i);
+			__m128 ex = _mm_loadu_ps(soa.extentX + i), ey = _mm_loadu_ps(soa.extentY + i), ez = _mm_loadu_ps(soa.extentZ + i);
+			__m128 in = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			for (int p = 0; p < 6; p++) {
+				__m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(pl[p * 4], cx), _mm_mul_ps(pl[p * 4 + 1], cy)), _mm_add_ps(_mm_mul_ps(pl[p * 4 + 2], cz), pl[p * 4 + 3]));
+				__m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(apl[p * 3], ex), _mm_mul_ps(apl[p * 3 + 1], ey)), _mm_mul_ps(apl[p * 3 + 2], ez));
+				in = _mm_and_ps(in, _mm_cmpge_ps(_mm_add_ps(dist, r), _mm_setzero_ps()));
+			}
+			n += storeVisible(_mm_movemask_ps(in), 4, visible + i);
+		}
+		return n + skScalarKernels::cullAabbRange(planes, soa, visible, i, count);
+	}
+	SK_TARGET_SSE41 static size_t cullSphere(const float* planes, const skSphereSoA& soa, unsigned char* visible, size_t count) {
+		__m128 pl[24];
+		for (int k = 0; k < 24; k++) {
+			pl[k] = _mm_set1_ps(planes[k]);
+		}
+		size_t n = 0, i = 0;
+		for (; i + 4 <= count; i += 4) {
+			__m128 x = _mm_loadu_ps(soa.x + i), y = _mm_loadu_ps(soa.y + i), z = _mm_loadu_ps(soa.z + i);
+			__m128 negR = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(soa.radius + i));
+			__m128 in = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			for (int p = 0; p < 6; p++) {
+				__m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(pl[p * 4], x), _mm_mul_ps(pl[p * 4 + 1], y)), _mm_add_ps(_mm_mul_ps(pl[p * 4 + 2], z), pl[p * 4 + 3]));
+				in = _mm_and_ps(in, _mm_cmpge_ps(dist, negR));
+			}
+			n += storeVisible(_mm_movemask_ps(in), 4, visible + i);
+		}
+		return n + skScalarKernels::cullSphereRange(planes, soa, visible, i, count);
+	}
+	// Same bit tricks as skScalarKernels::floatToHalf, 4 lanes with blends for the 3 cases
+	SK_TARGET_SSE41 static void floatToHalfBatch(const float* in, uint16_t* out, size_t count) {
+		const __m128i signMask = _mm_set1_epi32((int)0x80000000u);
+		const __m128 magic = _mm_castsi128_ps(_mm_set1_epi32(0x3f000000));
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			__m128i u = _mm_castps_si128(_mm_loadu_ps(in + i));
+			__m128i sign = _mm_and_si128(u, signMask);
+			u = _mm_xor_si128(u, sign);
+			__m128i infNan = _mm_blendv_epi8(_mm_set1_epi32(0x7c00), _mm_set1_epi32(0x7e00), _mm_cmpgt_epi32(u, _mm_set1_epi32(0x7f800000)));
+			__m128i sub = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(u), magic)), _mm_castps_si128(magic));
+			__m128i mantOdd = _mm_and_si128(_mm_srli_epi32(u, 13), _mm_set1_epi32(1));
+			__m128i norm = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(u, _mm_set1_epi32((int)0xc8000fffu)), mantOdd), 13);
+			__m128i h = _mm_blendv_epi8(norm, sub, _mm_cmplt_epi32(u, _mm_set1_epi32(0x38800000)));
+			h = _mm_blendv_epi8(h, infNan, _mm_cmpgt_epi32(u, _mm_set1_epi32(0x477fffff)));
+			h = _mm_or_si128(h, _mm_srli_epi32(sign, 16));
+			// halves are at most 0xffff so the unsigned saturating pack is exact
+			_mm_storel_epi64((__m128i*)(out + i), _mm_packus_epi32(h, h));
+		}
+		skScalarKernels::floatToHalfRange(in, out, i, count);
+	}
+	SK_TARGET_SSE41 static void halfToFloatBatch(const uint16_t* in, float* out, size_t count) {
+		const __m128i expMask = _mm_set1_epi32(0x0f800000);
+		const __m128 magic = _mm_castsi128_ps(_mm_set1_epi32(0x38800000));
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			__m128i h = _mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i*)(in + i)));
+			__m128i u = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x7fff)), 13);
+			__m128i exp = _mm_and_si128(u, expMask);
+			u = _mm_add_epi32(u, _mm_set1_epi32(0x38000000));
+			__m128i infNan = _mm_add_epi32(u, _mm_set1_epi32(0x38000000));
+			__m128i sub = _mm_castps_si128(_mm_sub_ps(_mm_castsi128_ps(_mm_add_epi32(u, _mm_set1_epi32(0x00800000))), magic));
+			u = _mm_blendv_epi8(u, infNan, _mm_cmpeq_epi32(exp, expMask));
+			u = _mm_blendv_epi8(u, sub, _mm_cmpeq_epi32(exp, _mm_setzero_si128()));
+			u = _mm_or_si128(u, _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x8000)), 16));
+			_mm_storeu_ps(out + i, _mm_castsi128_ps(u));
+		}
+		skScalarKernels::halfToFloatRange(in, out, i, count);
+	}
+	// cvtps rounds to nearest even under the default MXCSR, same as lrint in the scalar path
+	SK_TARGET_SSE41 static __m128i quantize(const float* in, float lo, float scale) {
+		__m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(in), _mm_set1_ps(lo)), _mm_set1_ps(1.0f));
+		return _mm_cvtps_epi32(_mm_mul_ps(v, _mm_set1_ps(scale)));
+	}
+	SK_TARGET_SSE41 static void packSnorm16Batch(const float* in, int16_t* out, size_t count) {
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			_mm_storeu_si128((__m128i*)(out + i), _mm_packs_epi32(quantize(in + i, -1.0f, 32767.0f), quantize(in + i + 4, -1.0f, 32767.0f)));
+		}
+		skScalarKernels::packSnorm16Range(in, out, i, count);
+	}
+	SK_TARGET_SSE41 static void packUnorm16Batch(const float* in, uint16_t* out, size_t count) {
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			_mm_storeu_si128((__m128i*)(out + i), _mm_packus_epi32(quantize(in + i, 0.0f, 65535.0f), quantize(in + i + 4, 0.0f, 65535.0f)));
+		}
+		skScalarKernels::packUnorm16Range(in, out, i, count);
+	}
+	SK_TARGET_SSE41 static void packUnorm8Batch(const float* in, uint8_t* out, size_t count) {
+		size_t i = 0;
+		for (; i + 16 <= count; i += 16) {
+			__m128i lo = _mm_packus_epi32(quantize(in + i, 0.0f, 255.0f), quantize(in + i + 4, 0.0f, 255.0f));
+			__m128i hi = _mm_packus_epi32(quantize(in + i + 8, 0.0f, 255.0f), quantize(in + i + 12, 0.0f, 255.0f));
+			_mm_storeu_si128((__m128i*)(out + i), _mm_packus_epi16(lo, hi));
+		}
+		skScalarKernels::packUnorm8Range(in, out, i, count);
+	}
+	// Octahedral fold for 4 normals, returns the (u, v) pairs before quantization
+	SK_TARGET_SSE41 static void octFold(__m128 x, __m128 y, __m128 z, __m128* u, __m128* v) {
+		const __m128 signBit = _mm_set1_ps(-0.0f);
+		const __m128 one = _mm_set1_ps(1.0f);
+		__m128 l1 = _mm_add_ps(_mm_add_ps(_mm_andnot_ps(signBit, x), _mm_andnot_ps(signBit, y)), _mm_andnot_ps(signBit, z));
+		__m128 inv = _mm_and_ps(_mm_div_ps(one, l1), _mm_cmpgt_ps(l1, _mm_setzero_ps()));
+		__m128 px = _mm_mul_ps(x, inv), py = _mm_mul_ps(y, inv);
+		// sign with +1 for zero, as the scalar path does
+		__m128 sx = _mm_blendv_ps(one, _mm_set1_ps(-1.0f), _mm_cmplt_ps(px, _mm_setzero_ps()));
+		__m128 sy = _mm_blendv_ps(one, _mm_set1_ps(-1.0f), _mm_cmplt_ps(py, _mm_setzero_ps()));
+		__m128 fx = _mm_mul_ps(_mm_sub_ps(one, _mm_andnot_ps(signBit, py)), sx);
+		__m128 fy = _mm_mul_ps(_mm_sub_ps(one, _mm_andnot_ps(signBit, px)), sy);
+		__m128 lower = _mm_cmplt_ps(z, _mm_setzero_ps());
+		*u = _mm_blendv_ps(px, fx, lower);
+		*v = _mm_blendv_ps(py, fy, lower);
+	}
+	SK_TARGET_SSE41 static void octEncodeBatch(const float* x, const float* y, const float* z, int16_t* out, size_t count) {
+		const __m128 scale = _mm_set1_ps(32767.0f);
+		const __m128 lo = _mm_set1_ps(-1.0f), hi = _mm_set1_ps(1.0f);
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			__m128 u, v;
+			octFold(_mm_loadu_ps(x + i), _mm_loadu_ps(y + i), _mm_loadu_ps(z + i), &u, &v);
+			__m128i qu = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(u, lo), hi), scale));
+			__m128i qv = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(v, lo), hi), scale));
+			// interleave to u0 v0 u1 v1 ... before narrowing
+			__m128i packed = _mm_packs_epi32(_mm_unpacklo_epi32(qu, qv), _mm_unpackhi_epi32(qu, qv));
+			_mm_storeu_si128((__m128i*)(out + i * 2), packed);
+		}
+		skScalarKernels::octEncodeRange(x, y, z, out, i, count);
+	}
+};
+
+struct skAvx2Kernels {
+	// Two result rows per 256-bit register: low lane row i, high lane row i + 1
+	SK_TARGET_AVX2 static __m256 pairBroadcast(float lo, float hi) {
+		return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(lo)), _mm_set1_ps(hi), 1);
+	}
+	SK_TARGET_AVX2 static void multMat4(const float* a, const float* b, float* out) {
+		__m256 b0 = _mm256_broadcast_ps((const __m128*)(b + 0));
+		__m256 b1 = _mm256_broadcast_ps((const __m128*)(b + 4));
+		__m256 b2 = _mm256_broadcast_ps((const __m128*)(b + 8));
+		__m256 b3 = _mm256_broadcast_ps((const __m128*)(b + 12));
+		__m256 r01 = _mm256_mul_ps(pairBroadcast(a[0], a[4]), b0);
+		r01 = _mm256_fmadd_ps(pairBroadcast(a[1], a[5]), b1, r01);
+		r01 = _mm256_fmadd_ps(pairBroadcast(a[2], a[6]), b2, r01);
+		r01 = _mm256_fmadd_ps(pairBroadcast(a[3], a[7]), b3, r01);
+		__m256 r23 = _mm256_mul_ps(pairBroadcast(a[8], a[12]), b0);
+		r23 = _mm256_fmadd_ps(pairBroadcast(a[9], a[13]), b1, r23);
+		r23 = _mm256_fmadd_ps(pairBroadcast(a[10], a[14]), b2, r23);
+		r23 = _mm256_fmadd_ps(pairBroadcast(a[11], a[15]), b3, r23);
+		_mm256_storeu_ps(out + 0, r01);
+		_mm256_storeu_ps(out + 8, r23);
+	}
+	SK_TARGET_AVX2 static void multMat4Batch(const float* a, const float* b, float* out, size_t count) {
+		for (size_t n = 0; n < count; n++) {
+			multMat4(a + n * 16, b + n * 16, out + n * 16);
+		}
+	}
+	SK_TARGET_AVX2 static void addMat4(const float* a, const float* b, float* out) {
+		_mm256_storeu_ps(out + 0, _mm256_add_ps(_mm256_loadu_ps(a + 0), _mm256_loadu_ps(b + 0)));
+		_mm256_storeu_ps(out + 8, _mm256_add_ps(_mm256_loadu_ps(a + 8), _mm256_loadu_ps(b + 8)));
+	}
+	SK_TARGET_AVX2 static void multVect4(const float* m, const float* v, float* out) {
+		__m128 r = _mm_mul_ps(_mm_set1_ps(v[0]), _mm_loadu_ps(m + 0));
+		r = _mm_fmadd_ps(_mm_set1_ps(v[1]), _mm_loadu_ps(m + 4), r);
+		r = _mm_fmadd_ps(_mm_set1_ps(v[2]), _mm_loadu_ps(m + 8), r);
+		r = _mm_fmadd_ps(_mm_set1_ps(v[3]), _mm_loadu_ps(m + 12), r);
+		_mm_storeu_ps(out, r);
+	}
+	// Two vectors per iteration, same lane split as multMat4
+	SK_TARGET_AVX2 static void multVect4Batch(const float* m, const float* v, float* out, size_t count) {
+		__m256 m0 = _mm256_broadcast_ps((const __m128*)(m + 0));
+		__m256 m1 = _mm256_broadcast_ps((const __m128*)(m + 4));
+		__m256 m2 = _mm256_broadcast_ps((const __m128*)(m + 8));
+		__m256 m3 = _mm256_broadcast_ps((const __m128*)(m + 12));
+		size_t n = 0;
+		for (; n + 2 <= count; n += 2) {
+			const float* in = v + n * 4;
+			__m256 r = _mm256_mul_ps(pairBroadcast(in[0], in[4]), m0);
+			r = _mm256_fmadd_ps(pairBroadcast(in[1], in[5]), m1, r);
+			r = _mm256_fmadd_ps(pairBroadcast(in[2], in[6]), m2, r);
+			r = _mm256_fmadd_ps(pairBroadcast(in[3], in[7]), m3, r);
+			_mm256_storeu_ps(out + n * 4, r);
+		}
+		if (n < count) {
+			multVect4(m, v + n * 4, out + n * 4);
+		}
+	}
+	// Eight lanes at once, same reduction and polynomials as the SSE path
+	SK_TARGET_AVX2 static void sincos(__m256 x, __m256* sOut, __m256* cOut) {
+		typedef skSinCosConst k;
+		const __m256 signMask = _mm256_castsi256_ps(_mm256_set1_epi32((int)0x80000000));
+		__m256 sinSign = _mm256_and_ps(x, signMask);
+		x = _mm256_andnot_ps(signMask, x);
+		__m256i j = _mm256_cvttps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(k::fourOverPi)));
+		j = _mm256_and_si256(_mm256_add_epi32(j, _mm256_set1_epi32(1)), _mm256_set1_epi32(~1));
+		__m256 y = _mm256_cvtepi32_ps(j);
+		__m256 sinFlip = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(j, _mm256_set1_epi32(4)), 29));
+		__m256 cosSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_andnot_si256(_mm256_sub_epi32(j, _mm256_set1_epi32(2)), _mm256_set1_epi32(4)), 29));
+		__m256 polyMask = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(j, _mm256_set1_epi32(2)), _mm256_setzero_si256()));
+		x = _mm256_fmadd_ps(y, _mm256_set1_ps(k::dp1), x);
+		x = _mm256_fmadd_ps(y, _mm256_set1_ps(k::dp2), x);
+		x = _mm256_fmadd_ps(y, _mm256_set1_ps(k::dp3), x);
+		__m256 z = _mm256_mul_ps(x, x);
+		__m256 pc = _mm256_fmadd_ps(_mm256_set1_ps(k::cos0), z, _mm256_set1_ps(k::cos1));
+		pc = _mm256_fmadd_ps(pc, z, _mm256_set1_ps(k::cos2));
+		pc = _mm256_mul_ps(_mm256_mul_ps(pc, z), z);
+		pc = _mm256_add_ps(_mm256_fnmadd_ps(z, _mm256_set1_ps(0.5f), pc), _mm256_set1_ps(1.0f));
+		__m256 ps = _mm256_fmadd_ps(_mm256_set1_ps(k::sin0), z, _mm256_set1_ps(k::sin1));
+		ps = _mm256_fmadd_ps(ps, z, _mm256_set1_ps(k::sin2));
+		ps = _mm256_fmadd_ps(_mm256_mul_ps(ps, z), x, x);
+		*sOut = _mm256_xor_ps(_mm256_blendv_ps(pc, ps, polyMask), _mm256_xor_ps(sinSign, sinFlip));
+		*cOut = _mm256_xor_ps(_mm256_blendv_ps(ps, pc, polyMask), cosSign);
+	}
+	SK_TARGET_AVX2 static void sincosBatch(const float* angle, float* sOut, float* cOut, size_t count) {
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			__m256 sv, cv;
+			sincos(_mm256_loadu_ps(angle + i), &sv, &cv);
+			_mm256_storeu_ps(sOut + i, sv);
+			_mm256_storeu_ps(cOut + i, cv);
+		}
+		skScalarKernels::sincosRange(angle, sOut, cOut, i, count);
+	}
+	SK_TARGET_AVX2 static __m256 rsqrtNewton(__m256 x) {
+		__m256 r = _mm256_rsqrt_ps(x);
+		__m256 halfXrr = _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(0.5f), x), _mm256_mul_ps(r, r));
+		return _mm256_mul_ps(r, _mm256_sub_ps(_mm256_set1_ps(1.5f), halfXrr));
+	}
+	SK_TARGET_AVX2 static void normalize3Batch(float* x, float* y, float* z, size_t count) {
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			__m256 vx = _mm256_loadu_ps(x + i), vy = _mm256_loadu_ps(y + i), vz = _mm256_loadu_ps(z + i);
+			__m256 len2 = _mm256_fmadd_ps(vz, vz, _mm256_fmadd_ps(vy, vy, _mm256_mul_ps(vx, vx)));
+			__m256 inv = _mm256_and_ps(_mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(len2)), _mm256_cmp_ps(len2, _mm256_setzero_ps(), _CMP_GT_OQ));
+			_mm256_storeu_ps(x + i, _mm256_mul_ps(vx, inv));
+			_mm256_storeu_ps(y + i, _mm256_mul_ps(vy, inv));
+			_mm256_storeu_ps(z + i, _mm256_mul_ps(vz, inv));
+		}
+		skScalarKernels::normalize3Range(x, y, z, i, count);
+	}
+	SK_TARGET_AVX2 static void normalize3FastBatch(float* x, float* y, float* z, size_t count) {
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			__m256 vx = _mm256_loadu_ps(x + i), vy = _mm256_loadu_ps(y + i), vz = _mm256_loadu_ps(z + i);
+			__m256 len2 = _mm256_fmadd_ps(vz, vz, _mm256_fmadd_ps(vy, vy, _mm256_mul_ps(vx, vx)));
+			__m256 inv = _mm256_and_ps(rsqrtNewton(len2), _mm256_cmp_ps(len2, _mm256_setzero_ps(), _CMP_GT_OQ));
+			_mm256_storeu_ps(x + i, _mm256_mul_ps(vx, inv));
+			_mm256_storeu_ps(y + i, _mm256_mul_ps(vy, inv));
+			_mm256_storeu_ps(z + i, _mm256_mul_ps(vz, inv));
+		}
+		skScalarKernels::normalize3Range(x, y, z, i, count);
+	}
+	// Inverse of storeMatrices: e[k] gets element k of 8 consecutive matrices
+	SK_TARGET_AVX2 static void loadMatrices(const float* in, __m256 e[16]) {
+		for (int n = 0; n < 8; n++) {
+			e[n] = _mm256_loadu_ps(in + n * 16 + 0);
+			e[8 + n] = _mm256_loadu_ps(in + n * 16 + 8);
+		}
+		transpose8(e);
+		transpose8(e + 8);
+	}
+	SK_TARGET_AVX2 static __m256 fms(__m256 a, __m256 b, __m256 c, __m256 d) {
+		return _mm256_sub_ps(_mm256_mul_ps(a, b), _mm256_mul_ps(c, d));
+	}
+	SK_TARGET_AVX2 static __m256 sum3(__m256 a, __m256 b, __m256 c, __m256 d, __m256 e, __m256 f) {
+		return _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(a, b), _mm256_mul_ps(c, d)), _mm256_mul_ps(e, f));
+	}
+	SK_TARGET_AVX2 static void inverseBatch(const float* in, float* out, size_t count) {
+		size_t i = 0;
+		const __m256 one = _mm256_set1_ps(1.0f);
+		for (; i + 8 <= count; i += 8) {
+			__m256 e[16];
+			loadMatrices(in + i * 16, e);
+			__m256 s0 = fms(e[0], e[5], e[4], e[1]), s1 = fms(e[0], e[6], e[4], e[2]), s2 = fms(e[0], e[7], e[4], e[3]);
+			__m256 s3 = fms(e[1], e[6], e[5], e[2]), s4 = fms(e[1], e[7], e[5], e[3]), s5 = fms(e[2], e[7], e[6], e[3]);
+			__m256 c5 = fms(e[10], e[15], e[14], e[11]), c4 = fms(e[9], e[15], e[13], e[11]), c3 = fms(e[9], e[14], e[13], e[10]);
+			__m256 c2 = fms(e[8], e[15], e[12], e[11]), c1 = fms(e[8], e[14], e[12], e[10]), c0 = fms(e[8], e[13], e[12], e[9]);
+			__m256 det = _mm256_add_ps(_mm256_add_ps(fms(s0, c5, s1, c4), fms(s2, c3, _mm256_xor_ps(_mm256_set1_ps(-0.0f), s3), c2)), fms(s5, c0, s4, c1));
+			__m256 inv = _mm256_div_ps(one, det);
+			__m256 o[16] = {
+				sum3(e[5], c5, e[6], c4, e[7], c3), sum3(e[2], c4, e[1], c5, _mm256_xor_ps(_mm256_set1_ps(-0.0f), e[3]), c3),
+				sum3(e[13], s5, e[14], s4, e[15], s3), sum3(e[10], s4, e[9], s5, _mm256_xor_ps(_mm256_set1_ps(-0.0f), e[11]), s3),
+				sum3(e[6], c2, e[4], c5, _mm256_xor_ps(_mm256_set1_ps(-0.0f), e[7]), c1), sum3(e[0], c5, e[2], c2, e[3], c1),
+				sum3(e[14], s2, e[12], s5, _mm256_xor_ps(_mm256_set1_ps(-0.0f), e[15]), s1), sum3(e[8], s5, e[10], s2, e[11], s1),
+				sum3(e[4], c4, e[5], c2, e[7], c0), sum3(e[1], c2, e[0], c4, _mm256_xor_ps(_mm256_set1_ps(-0.0f), e[3]), c0),
+				sum3(e[12], s4, e[13], s2, e[15], s0), sum3(e[9], s2, e[8], s4, _mm256_xor_ps(_mm256_set1_ps(-0.0f), e[11]), s0),
+				sum3(e[5], c1, e[4], c3, _mm256_xor_ps(_mm256_set1_ps(-0.0f), e[6]), c0), sum3(e[0], c3, e[1], c1, e[2], c0),
+				sum3(e[13], s1, e[12], s3, _mm256_xor_ps(_mm256_set1_ps(-0.0f), e[14]), s0), sum3(e[8], s3, e[9], s1, e[10], s0)
+			};
+			for (int k = 0; k < 16; k++) {
+				o[k] = _mm256_mul_ps(o[k], inv);
+			}
+			storeMatrices(o, out + i * 16);
+		}
+		skScalarKernels::inverseRange(in, out, i, count);
+	}
+	// Cross products of the basis columns; row r of the 3x3 inverse is r[3r..3r+2] / det
+	SK_TARGET_AVX2 static __m256 affineCofactors(const __m256 e[16], __m256 r[9]) {
+		r[0] = fms(e[5], e[10], e[6], e[9]); r[1] = fms(e[6], e[8], e[4], e[10]); r[2] = fms(e[4], e[9], e[5], e[8]);
+		r[3] = fms(e[9], e[2], e[10], e[1]); r[4] = fms(e[10], e[0], e[8], e[2]); r[5] = fms(e[8], e[1], e[9], e[0]);
+		r[6] = fms(e[1], e[6], e[2], e[5]); r[7] = fms(e[2], e[4], e[0], e[6]); r[8] = fms(e[0], e[5], e[1], e[4]);
+		return _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e[0], r[0]), _mm256_mul_ps(e[1], r[1])), _mm256_mul_ps(e[2], r[2]));
+	}
+	SK_TARGET_AVX2 static __m256 nearZero(__m256 x, __m256 eps) {
+		return _mm256_cmp_ps(_mm256_andnot_ps(_mm256_set1_ps(-0.0f), x), eps, _CMP_LT_OQ);
+	}
+	// All lanes rigid? Then the transpose replaces the cofactors and the divide
+	SK_TARGET_AVX2 static bool allRigid(const __m256 e[16]) {
+		const __m256 eps = _mm256_set1_ps(1e-4f), one = _mm256_set1_ps(1.0f);
+		__m256 m = nearZero(_mm256_sub_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e[0], e[0]), _mm256_mul_ps(e[1], e[1])), _mm256_mul_ps(e[2], e[2])), one), eps);
+		m = _mm256_and_ps(m, nearZero(_mm256_sub_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e[4], e[4]), _mm256_mul_ps(e[5], e[5])), _mm256_mul_ps(e[6], e[6])), one), eps));
+		m = _mm256_and_ps(m, nearZero(_mm256_sub_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e[8], e[8]), _mm256_mul_ps(e[9], e[9])), _mm256_mul_ps(e[10], e[10])), one), eps));
+		m = _mm256_and_ps(m, nearZero(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e[0], e[4]), _mm256_mul_ps(e[1], e[5])), _mm256_mul_ps(e[2], e[6])), eps));
+		m = _mm256_and_ps(m, nearZero(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e[0], e[8]), _mm256_mul_ps(e[1], e[9])), _mm256_mul_ps(e[2], e[10])), eps));
+		m = _mm256_and_ps(m, nearZero(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e[4], e[8]), _mm256_mul_ps(e[5], e[9])), _mm256_mul_ps(e[6], e[10])), eps));
+		return _mm256_movemask_ps(m) == 0xFF;
+	}
+	SK_TARGET_AVX2 static void affineInverseBatch(const float* in, float* out, size_t count) {
+		size_t i = 0;
+		const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f);
+		for (; i + 8 <= count; i += 8) {
+			__m256 e[16], r[9];
+			loadMatrices(in + i * 16, e);
+			if (allRigid(e)) {
+				r[0] = e[0]; r[1] = e[1]; r[2] = e[2];
+				r[3] = e[4]; r[4] = e[5]; r[5] = e[6];
+				r[6] = e[8]; r[7] = e[9]; r[8] = e[10];
+			}
+			else {
+				__m256 inv = _mm256_div_ps(one, affineCofactors(e, r));
+				for (int k = 0; k < 9; k++) {
+					r[k] = _mm256_mul_ps(r[k], inv);
+				}
+			}
+			__m256 tx = e[12], ty = e[13], tz = e[14];
+			__m256 o[16] = {
+				r[0], r[3], r[6], zero,
+				r[1], r[4], r[7], zero,
+				r[2], r[5], r[8], zero,
+				_mm256_xor_ps(_mm256_set1_ps(-0.0f), _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r[0], tx), _mm256_mul_ps(r[1], ty)), _mm256_mul_ps(r[2], tz))),
+				_mm256_xor_ps(_mm256_set1_ps(-0.0f), _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r[3], tx), _mm256_mul_ps(r[4], ty)), _mm256_mul_ps(r[5], tz))),
+				_mm256_xor_ps(_mm256_set1_ps(-0.0f), _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r[6], tx), _mm256_mul_ps(r[7], ty)), _mm256_mul_ps(r[8], tz))), one
+			};
+			storeMatrices(o, out + i * 16);
+		}
+		skScalarKernels::affineInverseRange(in, out, i, count);
+	}
+	SK_TARGET_AVX2 static void normalMatrixBatch(const float* in, float* out, size_t count) {
+		size_t i = 0;
+		const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f);
+		for (; i + 8 <= count; i += 8) {
+			__m256 e[16], r[9];
+			loadMatrices(in + i * 16, e);
+			__m256 inv = _mm256_div_ps(one, affineCofactors(e, r));
+			__m256 o[16] = {
+				_mm256_mul_ps(r[0], inv), _mm256_mul_ps(r[1], inv), _mm256_mul_ps(r[2], inv), zero,
+				_mm256_mul_ps(r[3], inv), _mm256_mul_ps(r[4], inv), _mm256_mul_ps(r[5], inv), zero,
+				_mm256_mul_ps(r[6], inv), _mm256_mul_ps(r[7], inv), _mm256_mul_ps(r[8], inv), zero,
+				zero, zero, zero, one
+			};
+			storeMatrices(o, out + i * 16);
+		}
+		skScalarKernels::normalMatrixRange(in, out, i, count);
+	}
+	SK_TARGET_AVX2 static __m256 loadOrOne(const float* p, size_t i) {
+		return p ? _mm256_loadu_ps(p + i) : _mm256_set1_ps(1.0f);
+	}
+	// In place 8x8 transpose, row k ends up holding what was column k
+	SK_TARGET_AVX2 static void transpose8(__m256 r[8]) {
+		__m256 t0 = _mm256_unpacklo_ps(r[0], r[1]), t1 = _mm256_unpackhi_ps(r[0], r[1]);
+		__m256 t2 = _mm256_unpacklo_ps(r[2], r[3]), t3 = _mm256_unpackhi_ps(r[2], r[3]);
+		__m256 t4 = _mm256_unpacklo_ps(r[4], r[5]), t5 = _mm256_unpackhi_ps(r[4], r[5]);
+		__m256 t6 = _mm256_unpacklo_ps(r[6], r[7]), t7 = _mm256_unpackhi_ps(r[6], r[7]);
+		__m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0)), s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+		__m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0)), s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+		__m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0)), s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+		__m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0)), s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+		r[0] = _mm256_permute2f128_ps(s0, s4, 0x20); r[1] = _mm256_permute2f128_ps(s1, s5, 0x20);
+		r[2] = _mm256_permute2f128_ps(s2, s6, 0x20); r[3] = _mm256_permute2f128_ps(s3, s7, 0x20);
+		r[4] = _mm256_permute2f128_ps(s0, s4, 0x31); r[5] = _mm256_permute2f128_ps(s1, s5, 0x31);
+		r[6] = _mm256_permute2f128_ps(s2, s6, 0x31); r[7] = _mm256_permute2f128_ps(s3, s7, 0x31);
+	}
+	// e[0..15] hold matrix element k for eight instances, write them out as eight matrices
+	SK_TARGET_AVX2 static void storeMatrices(__m256 e[16], float* out) {
+		transpose8(e);
+		transpose8(e + 8);
+		for (int n = 0; n < 8; n++) {
+			_mm256_storeu_ps(out + n * 16 + 0, e[n]);
+			_mm256_storeu_ps(out + n * 16 + 8, e[8 + n]);
+		}
+	}
+	SK_TARGET_AVX2 static void storeTRS(const skTransformSoA& soa, size_t i, __m256 r[9], float* out) {
+		__m256 sx = loadOrOne(soa.scaleX, i), sy = loadOrOne(soa.scaleY, i), sz = loadOrOne(soa.scaleZ, i);
+		__m256 zero = _mm256_setzero_ps();
+		__m256 e[16] = {
+			_mm256_mul_ps(r[0], sx), _mm256_mul_ps(r[1], sx), _mm256_mul_ps(r[2], sx), zero,
+			_mm256_mul_ps(r[3], sy), _mm256_mul_ps(r[4], sy), _mm256_mul_ps(r[5], sy), zero,
+			_mm256_mul_ps(r[6], sz), _mm256_mul_ps(r[7], sz), _mm256_mul_ps(r[8], sz), zero,
+			_mm256_loadu_ps(soa.posX + i), _mm256_loadu_ps(soa.posY + i), _mm256_loadu_ps(soa.posZ + i), _mm256_set1_ps(1.0f)
+		};
+		storeMatrices(e, out + i * 16);
+	}
+	SK_TARGET_AVX2 static void composeAxisAngle(const skTransformSoA& soa, float* out, size_t count) {
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			__m256 x = _mm256_loadu_ps(soa.axisX + i), y = _mm256_loadu_ps(soa.axisY + i), z = _mm256_loadu_ps(soa.axisZ + i);
+			__m256 len2 = _mm256_fmadd_ps(z, z, _mm256_fmadd_ps(y, y, _mm256_mul_ps(x, x)));
+			__m256 inv = _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(len2));
+			x = _mm256_mul_ps(x, inv); y = _mm256_mul_ps(y, inv); z = _mm256_mul_ps(z, inv);
+			__m256 s, c;
+			sincos(_mm256_loadu_ps(soa.angle + i), &s, &c);
+			__m256 t = _mm256_sub_ps(_mm256_set1_ps(1.0f), c);
+			__m256 tx = _mm256_mul_ps(t, x), ty = _mm256_mul_ps(t, y), tz = _mm256_mul_ps(t, z);
+			__m256 sx = _mm256_mul_ps(s, x), sy = _mm256_mul_ps(s, y), sz = _mm256_mul_ps(s, z);
+			__m256 txy = _mm256_mul_ps(tx, y), txz = _mm256_mul_ps(tx, z), tyz = _mm256_mul_ps(ty, z);
+			__m256 r[9] = {
+				_mm256_fmadd_ps(tx, x, c), _mm256_add_ps(txy, sz), _mm256_sub_ps(txz, sy),
+				_mm256_sub_ps(txy, sz), _mm256_fmadd_ps(ty, y, c), _mm256_add_ps(tyz, sx),
+				_mm256_add_ps(txz, sy), _mm256_sub_ps(tyz, sx), _mm256_fmadd_ps(tz, z, c)
+			};
+			storeTRS(soa, i, r, out);
+		}
+		skScalarKernels::composeAxisAngleRange(soa, out, i, count);
+	}
+	SK_TARGET_AVX2 static void quatBasis(__m256 x, __m256 y, __m256 z, __m256 w, __m256 r[9]) {
+		const __m256 one = _mm256_set1_ps(1.0f), two = _mm256_set1_ps(2.0f);
+		__m256 xx = _mm256_mul_ps(x, x), yy = _mm256_mul_ps(y, y), zz = _mm256_mul_ps(z, z);
+		__m256 xy = _mm256_mul_ps(x, y), xz = _mm256_mul_ps(x, z), yz = _mm256_mul_ps(y, z);
+		__m256 wx = _mm256_mul_ps(w, x), wy = _mm256_mul_ps(w, y), wz = _mm256_mul_ps(w, z);
+		r[0] = _mm256_fnmadd_ps(two, _mm256_add_ps(yy, zz), one);
+		r[1] = _mm256_mul_ps(two, _mm256_add_ps(xy, wz));
+		r[2] = _mm256_mul_ps(two, _mm256_sub_ps(xz, wy));
+		r[3] = _mm256_mul_ps(two, _mm256_sub_ps(xy, wz));
+		r[4] = _mm256_fnmadd_ps(two, _mm256_add_ps(xx, zz), one);
+		r[5] = _mm256_mul_ps(two, _mm256_add_ps(yz, wx));
+		r[6] = _mm256_mul_ps(two, _mm256_add_ps(xz, wy));
+		r[7] = _mm256_mul_ps(two, _mm256_sub_ps(yz, wx));
+		r[8] = _mm256_fnmadd_ps(two, _mm256_add_ps(xx, yy), one);
+	}
+	SK_TARGET_AVX2 static void composeQuat(const skTransformSoA& soa, float* out, size_t count) {
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			__m256 r[9];
+			quatBasis(_mm256_loadu_ps(soa.quatX + i), _mm256_loadu_ps(soa.quatY + i), _mm256_loadu_ps(soa.quatZ + i), _mm256_loadu_ps(soa.quatW + i), r);
+			storeTRS(soa, i, r, out);
+		}
+		skScalarKernels::composeQuatRange(soa, out, i, count);
+	}
+	SK_TARGET_AVX2 static __m256 dot4(__m256 ax, __m256 ay, __m256 az, __m256 aw, __m256 bx, __m256 by, __m256 bz, __m256 bw) {
+		return _mm256_fmadd_ps(aw, bw, _mm256_fmadd_ps(az, bz, _mm256_fmadd_ps(ay, by, _mm256_mul_ps(ax, bx))));
+	}
+	SK_TARGET_AVX2 static void storeNormalized(const skQuatSoA& out, size_t i, __m256 x, __m256 y, __m256 z, __m256 w) {
+		__m256 inv = _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(dot4(x, y, z, w, x, y, z, w)));
+		_mm256_storeu_ps(out.x + i, _mm256_mul_ps(x, inv));
+		_mm256_storeu_ps(out.y + i, _mm256_mul_ps(y, inv));
+		_mm256_storeu_ps(out.z + i, _mm256_mul_ps(z, inv));
+		_mm256_storeu_ps(out.w + i, _mm256_mul_ps(w, inv));
+	}
+	SK_TARGET_AVX2 static void quatMult(const skQuatSoA& a, const skQuatSoA& b, const skQuatSoA& out, size_t count) {
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			__m256 ax = _mm256_loadu_ps(a.x + i), ay = _mm256_loadu_ps(a.y + i), az = _mm256_loadu_ps(a.z + i), aw = _mm256_loadu_ps(a.w + i);
+			__m256 bx = _mm256_loadu_ps(b.x + i), by = _mm256_loadu_ps(b.y + i), bz = _mm256_loadu_ps(b.z + i), bw = _mm256_loadu_ps(b.w + i);
+			__m256 x = _mm256_fmadd_ps(aw, bx, _mm256_fmadd_ps(ax, bw, _mm256_fmsub_ps(ay, bz, _mm256_mul_ps(az, by))));
+			__m256 y = _mm256_fmadd_ps(aw, by, _mm256_fmadd_ps(ay, bw, _mm256_fmsub_ps(az, bx, _mm256_mul_ps(ax, bz))));
+			__m256 z = _mm256_fmadd_ps(aw, bz, _mm256_fmadd_ps(az, bw, _mm256_fmsub_ps(ax, by, _mm256_mul_ps(ay, bx))));
+			__m256 w = _mm256_fmsub_ps(aw, bw, _mm256_fmadd_ps(az, bz, _mm256_fmadd_ps(ay, by, _mm256_mul_ps(ax, bx))));
+			_mm256_storeu_ps(out.x + i, x);
+			_mm256_storeu_ps(out.y + i, y);
+			_mm256_storeu_ps(out.z + i, z);
+			_mm256_storeu_ps(out.w + i, w);
+		}
+		skScalarKernels::quatMultRange(a, b, out, i, count);
+	}
+	SK_TARGET_AVX2 static void quatNormalize(const skQuatSoA& in, const skQuatSoA& out, size_t count) {
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			storeNormalized(out, i, _mm256_loadu_ps(in.x + i), _mm256_loadu_ps(in.y + i), _mm256_loadu_ps(in.z + i), _mm256_loadu_ps(in.w + i));
+		}
+		skScalarKernels::quatNormalizeRange(in, out, i, count);
+	}
+	SK_TARGET_AVX2 static void quatNlerp(const skQuatSoA& a, const skQuatSoA& b, const float* t, const skQuatSoA& out, size_t count) {
+		const __m256 signMask = _mm256_castsi256_ps(_mm256_set1_epi32((int)0x80000000));
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			__m256 ax = _mm256_loadu_ps(a.x + i), ay = _mm256_loadu_ps(a.y + i), az = _mm256_loadu_ps(a.z + i), aw = _mm256_loadu_ps(a.w + i);
+			__m256 bx = _mm256_loadu_ps(b.x + i), by = _mm256_loadu_ps(b.y + i), bz = _mm256_loadu_ps(b.z + i), bw = _mm256_loadu_ps(b.w + i);
+			__m256 tt = _mm256_loadu_ps(t + i);
+			__m256 wb = _mm256_xor_ps(tt, _mm256_and_ps(dot4(ax, ay, az, aw, bx, by, bz, bw), signMask));
+			__m256 wa = _mm256_sub_ps(_mm256_set1_ps(1.0f), tt);
+			storeNormalized(out, i,
+				_mm256_fmadd_ps(wa, ax, _mm256_mul_ps(wb, bx)), _mm256_fmadd_ps(wa, ay, _mm256_mul_ps(wb, by)),
+				_mm256_fmadd_ps(wa, az, _mm256_mul_ps(wb, bz)), _mm256_fmadd_ps(wa, aw, _mm256_mul_ps(wb, bw)));
+		}
+		skScalarKernels::quatNlerpRange(a, b, t, out, i, count);
+	}
+	SK_TARGET_AVX2 static __m256 slerpWeight(__m256 t, __m256 xm1, const __m256 u[8], const __m256 v[8]) {
+		__m256 t2 = _mm256_mul_ps(t, t);
+		__m256 f = _mm256_set1_ps(1.0f);
+		for (int k = 7; k >= 0; k--) {
+			__m256 bk = _mm256_mul_ps(_mm256_fmsub_ps(u[k], t2, v[k]), xm1);
+			f = _mm256_fmadd_ps(bk, f, _mm256_set1_ps(1.0f));
+		}
+		return _mm256_mul_ps(t, f);
+	}
+	SK_TARGET_AVX2 static void quatSlerp(const skQuatSoA& a, const skQuatSoA& b, const float* t, const skQuatSoA& out, size_t count) {
+		const __m256 signMask = _mm256_castsi256_ps(_mm256_set1_epi32((int)0x80000000));
+		__m256 u[8], v[8];
+		for (int k = 0; k < 8; k++) {
+			u[k] = _mm256_set1_ps(skSlerpConst::u(k));
+			v[k] = _mm256_set1_ps(skSlerpConst::v(k));
+		}
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			__m256 ax = _mm256_loadu_ps(a.x + i), ay = _mm256_loadu_ps(a.y + i), az = _mm256_loadu_ps(a.z + i), aw = _mm256_loadu_ps(a.w + i);
+			__m256 bx = _mm256_loadu_ps(b.x + i), by = _mm256_loadu_ps(b.y + i), bz = _mm256_loadu_ps(b.z + i), bw = _mm256_loadu_ps(b.w + i);
+			__m256 tt = _mm256_loadu_ps(t + i);
+			__m256 d = dot4(ax, ay, az, aw, bx, by, bz, bw);
+			__m256 sign = _mm256_and_ps(d, signMask);
+			__m256 xm1 = _mm256_sub_ps(_mm256_xor_ps(d, sign), _mm256_set1_ps(1.0f));
+			__m256 wa = slerpWeight(_mm256_sub_ps(_mm256_set1_ps(1.0f), tt), xm1, u, v);
+			__m256 wb = _mm256_xor_ps(slerpWeight(tt, xm1, u, v), sign);
+			_mm256_storeu_ps(out.x + i, _mm256_fmadd_ps(wa, ax, _mm256_mul_ps(wb, bx)));
+			_mm256_storeu_ps(out.y + i, _mm256_fmadd_ps(wa, ay, _mm256_mul_ps(wb, by)));
+			_mm256_storeu_ps(out.z + i, _mm256_fmadd_ps(wa, az, _mm256_mul_ps(wb, bz)));
+			_mm256_storeu_ps(out.w + i, _mm256_fmadd_ps(wa, aw, _mm256_mul_ps(wb, bw)));
+		}
+		skScalarKernels::quatSlerpRange(a, b, t, out, i, count);
+	}
+	SK_TARGET_AVX2 static void quatToMat(const skQuatSoA& in, float* out, size_t count) {
+		size_t i = 0;
+		const __m256 zero = _mm256_setzero_ps();
+		for (; i + 8 <= count; i += 8) {
+			__m256 r[9];
+			quatBasis(_mm256_loadu_ps(in.x + i), _mm256_loadu_ps(in.y + i), _mm256_loadu_ps(in.z + i), _mm256_loadu_ps(in.w + i), r);
+			__m256 e[16] = {
+				r[0], r[1], r[2], zero,
+				r[3], r[4], r[5], zero,
+				r[6], r[7], r[8], zero,
+				zero, zero, zero, _mm256_set1_ps(1.0f)
+			};
+			storeMatrices(e, out + i * 16);
+		}
+		skScalarKernels::quatToMatRange(in, out, i, count);
+	}
+	// 8 boxes against all 6 planes per iteration
+	SK_TARGET_AVX2 static size_t cullAabb(const float* planes, const skAabbSoA& soa, unsigned char* visible, size_t count) {
+		__m256 pl[24], apl[18];
+		__m256 signMask = _mm256_set1_ps(-0.0f);
+		for (int p = 0; p < 6; p++) {
+			for (int c = 0; c < 4; c++) {
+				pl[p * 4 + c] = _mm256_set1_ps(planes[p * 4 + c]);
+			}
+			for (int c = 0; c < 3; c++) {
+				apl[p * 3 + c] = _mm256_andnot_ps(signMask, pl[p * 4 + c]);
+			}
+		}
+		size_t n = 0, i = 0;
+		for (; i + 8 <= count; i += 8) {
+			__m256 cx = _mm256_loadu_ps(soa.centerX + i), cy = _mm256_loadu_ps(soa.centerY + i), cz = _mm256_loadu_ps(soa.centerZ + i);
+			__m256 ex = _mm256_loadu_ps(soa.extentX + i), ey = _mm256_loadu_ps(soa.extentY + i), ez = _mm256_loadu_ps(soa.extentZ + i);
+			__m256 in = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+			for (int p = 0; p < 6; p++) {
+				__m256 dist = _mm256_fmadd_ps(pl[p * 4], cx, _mm256_fmadd_ps(pl[p * 4 + 1], cy, _mm256_fmadd_ps(pl[p * 4 + 2], cz, pl[p * 4 + 3])));
+				__m256 r = _mm256_fmadd_ps(apl[p * 3], ex, _mm256_fmadd_ps(apl[p * 3 + 1], ey, _mm256_mul_ps(apl[p * 3 + 2], ez)));
+				in = _mm256_and_ps(in, _mm256_cmp_ps(_mm256_add_ps(dist, r), _mm256_setzero_ps(), _CMP_GE_OQ));
+			}
+			n += skSse41Kernels::storeVisible(_mm256_movemask_ps(in), 8, visible + i);
+		}
+		return n + skScalarKernels::cullAabbRange(planes, soa, visible, i, count);
+	}
+	SK_TARGET_AVX2 static size_t cullSphere(const float* planes, const skSphereSoA& soa, unsigned char* visible, size_t count) {
+		__m256 pl[24];
+		for (int k = 0; k < 24; k++) {
+			pl[k] = _mm256_set1_ps(planes[k]);
+		}
+		size_t n = 0, i = 0;
+		for (; i + 8 <= count; i += 8) {
+			__m256 x = _mm256_loadu_ps(soa.x + i), y = _mm256_loadu_ps(soa.y + i), z = _mm256_loadu_ps(soa.z + i);
+			__m256 negR = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(soa.radius + i));
+			__m256 in = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+			for (int p = 0; p < 6; p++) {
+				__m256 dist = _mm256_fmadd_ps(pl[p * 4], x, _mm256_fmadd_ps(pl[p * 4 + 1], y, _mm256_fmadd_ps(pl[p * 4 + 2], z, pl[p * 4 + 3])));
+				in = _mm256_and_ps(in, _mm256_cmp_ps(dist, negR, _CMP_GE_OQ));
+			}
+			n += skSse41Kernels::storeVisible(_mm256_movemask_ps(in), 8, visible + i);
+		}
+		return n + skScalarKernels::cullSphereRange(planes, soa, visible, i, count);
+	}
+	// F16C does the rounding and special cases in hardware
+	SK_TARGET_AVX2 static void floatToHalfBatch(const float* in, uint16_t* out, size_t count) {
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			_mm_storeu_si128((__m128i*)(out + i), _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT));
+		}
+		skScalarKernels::floatToHalfRange(in, out, i, count);
+	}
+	SK_TARGET_AVX2 static void halfToFloatBatch(const uint16_t* in, float* out, size_t count) {
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			_mm256_storeu_ps(out + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(in + i))));
+		}
+		skScalarKernels::halfToFloatRange(in, out, i, count);
+	}
+	// 8 lanes quantized, then split so the 128-bit packs keep element order
+	SK_TARGET_AVX2 static void quantize(const float* in, float lo, float scale, __m128i* first, __m128i* second) {
+		__m256 v = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(in), _mm256_set1_ps(lo)), _mm256_set1_ps(1.0f));
+		__m256i q = _mm256_cvtps_epi32(_mm256_mul_ps(v, _mm256_set1_ps(scale)));
+		*first = _mm256_castsi256_si128(q);
+		*second = _mm256_extracti128_si256(q, 1);
+	}
+	SK_TARGET_AVX2 static void packSnorm16Batch(const float* in, int16_t* out, size_t count) {
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			__m128i a, b;
+			quantize(in + i, -1.0f, 32767.0f, &a, &b);
+			_mm_storeu_si128((__m128i*)(out + i), _mm_packs_epi32(a, b));
+		}
+		skScalarKernels::packSnorm16Range(in, out, i, count);
+	}
+	SK_TARGET_AVX2 static void packUnorm16Batch(const float* in, uint16_t* out, size_t count) {
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			__m128i a, b;
+			quantize(in + i, 0.0f, 65535.0f, &a, &b);
+			_mm_storeu_si128((__m128i*)(out + i), _mm_packus_epi32(a, b));
+		}
+		skScalarKernels::packUnorm16Range(in, out, i, count);
+	}
+	SK_TARGET_AVX2 static void packUnorm8Batch(const float* in, uint8_t* out, size_t count) {
+		size_t i = 0;
+		for (; i + 16 <= count; i += 16) {
+			__m128i a, b, c, d;
+			quantize(in + i, 0.0f, 255.0f, &a, &b);
+			quantize(in + i + 8, 0.0f, 255.0f, &c, &d);
+			_mm_storeu_si128((__m128i*)(out + i), _mm_packus_epi16(_mm_packus_epi32(a, b), _mm_packus_epi32(c, d)));
+		}
+		skScalarKernels::packUnorm8Range(in, out, i, count);
+	}
+	SK_TARGET_AVX2 static void octEncodeBatch(const float* x, const float* y, const float* z, int16_t* out, size_t count) {
+		const __m256 signBit = _mm256_set1_ps(-0.0f);
+		const __m256 one = _mm256_set1_ps(1.0f), minusOne = _mm256_set1_ps(-1.0f), zero = _mm256_setzero_ps();
+		const __m256 scale = _mm256_set1_ps(32767.0f);
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			__m256 vx = _mm256_loadu_ps(x + i), vy = _mm256_loadu_ps(y + i), vz = _mm256_loadu_ps(z + i);
+			__m256 l1 = _mm256_add_ps(_mm256_add_ps(_mm256_andnot_ps(signBit, vx), _mm256_andnot_ps(signBit, vy)), _mm256_andnot_ps(signBit, vz));
+			__m256 inv = _mm256_and_ps(_mm256_div_ps(one, l1), _mm256_cmp_ps(l1, zero, _CMP_GT_OQ));
+			__m256 px = _mm256_mul_ps(vx, inv), py = _mm256_mul_ps(vy, inv);
+			__m256 sx = _mm256_blendv_ps(one, minusOne, _mm256_cmp_ps(px, zero, _CMP_LT_OQ));
+			__m256 sy = _mm256_blendv_ps(one, minusOne, _mm256_cmp_ps(py, zero, _CMP_LT_OQ));
+			__m256 fx = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_andnot_ps(signBit, py)), sx);
+			__m256 fy = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_andnot_ps(signBit, px)), sy);
+			__m256 lower = _mm256_cmp_ps(vz, zero, _CMP_LT_OQ);
+			__m256 u = _mm256_min_ps(_mm256_max_ps(_mm256_blendv_ps(px, fx, lower), minusOne), one);
+			__m256 v = _mm256_min_ps(_mm256_max_ps(_mm256_blendv_ps(py, fy, lower), minusOne), one);
+			__m256i qu = _mm256_cvtps_epi32(_mm256_mul_ps(u, scale));
+			__m256i qv = _mm256_cvtps_epi32(_mm256_mul_ps(v, scale));
+			// per-lane unpack gives pairs 0,1,4,5 | 2,3,6,7, the cross-lane permutes restore order
+			__m256i lo = _mm256_unpacklo_epi32(qu, qv), hi = _mm256_unpackhi_epi32(qu, qv);
+			__m256i first = _mm256_permute2x128_si256(lo, hi, 0x20);
+			__m256i second = _mm256_permute2x128_si256(lo, hi, 0x31);
+			__m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(first, second), 0xd8);
+			_mm256_storeu_si256((__m256i*)(out + i * 2), packed);
+		}
+		skScalarKernels::octEncodeRange(x, y, z, out, i, count);
+	}
+};
+#endif
+
+// Function table picked once from CPUID, every Mat4x4<float> fast path goes through here
+struct skKernels {
+	skSimdLevel level;
+	void (*multMat4)(const float* a, const float* b, float* out);
+	void (*multMat4Batch)(const float* a, const float* b, float* out, size_t count);
+	void (*addMat4)(const float* a, const float* b, float* out);
+	void (*multVect4)(const float* m, const float* v, float* out);
+	void (*multVect4Batch)(const float* m, const float* v, float* out, size_t count);
+	void (*composeAxisAngle)(const skTransformSoA& soa, float* out, size_t count);
+	void (*composeQuat)(const skTransformSoA& soa, float* out, size_t count);
+	void (*quatMult)(const skQuatSoA& a, const skQuatSoA& b, const skQuatSoA& out, size_t count);
+	void (*quatNormalize)(const skQuatSoA& in, const skQuatSoA& out, size_t count);
+	void (*quatNlerp)(const skQuatSoA& a, const skQuatSoA& b, const float* t, const skQuatSoA& out, size_t count);
+	void (*quatSlerp)(const skQuatSoA& a, const skQuatSoA& b, const float* t, const skQuatSoA& out, size_t count);
+	void (*quatToMat)(const skQuatSoA& in, float* out, size_t count);
+	void (*sincosBatch)(const float* angle, float* sOut, float* cOut, size_t count);
+	void (*normalize3Batch)(float* x, float* y, float* z, size_t count);
+	void (*normalize3FastBatch)(float* x, float* y, float* z, size_t count);
+	void (*inverseBatch)(const float* in, float* out, size_t count);
+	void (*affineInverseBatch)(const float* in, float* out, size_t count);
+	void (*normalMatrixBatch)(const float* in, float* out, size_t count);
+	size_t (*cullAabb)(const float* planes, const skAabbSoA& soa, unsigned char* visible, size_t count);
+	size_t (*cullSphere)(const float* planes, const skSphereSoA& soa, unsigned char* visible, size_t count);
+	void (*floatToHalfBatch)(const float* in, uint16_t* out, size_t count);
+	void (*halfToFloatBatch)(const uint16_t* in, float* out, size_t count);
+	void (*packSnorm16Batch)(const float* in, int16_t* out, size_t count);
+	void (*packUnorm16Batch)(const float* in, uint16_t* out, size_t count);
+	void (*packUnorm8Batch)(const float* in, uint8_t* out, size_t count);
+	void (*octEncodeBatch)(const float* x, const float* y, const float* z, int16_t* out, size_t count);
+
+	static skKernels forLevel(skSimdLevel level) {
+		skKernels k;
+		k.level = SK_SIMD_SCALAR;
+		k.multMat4 = skScalarKernels::multMat4;
+		k.multMat4Batch = skScalarKernels::multMat4Batch;
+		k.addMat4 = skScalarKernels::addMat4;
+		k.multVect4 = skScalarKernels::multVect4;
+		k.multVect4Batch = skScalarKernels::multVect4Batch;
+		k.composeAxisAngle = skScalarKernels::composeAxisAngle;
+		k.composeQuat = skScalarKernels::composeQuat;
+		k.quatMult = skScalarKernels::quatMult;
+		k.quatNormalize = skScalarKernels::quatNormalize;
+		k.quatNlerp = skScalarKernels::quatNlerp;
+		k.quatSlerp = skScalarKernels::quatSlerp;
+		k.quatToMat = skScalarKernels::quatToMat;
+		k.sincosBatch = skScalarKernels::sincosBatch;
+		k.inverseBatch = skScalarKernels::inverseBatch;
+		k.affineInverseBatch = skScalarKernels::affineInverseBatch;
+		k.normalMatrixBatch = skScalarKernels::normalMatrixBatch;
+		k.normalize3Batch = skScalarKernels::normalize3Batch;
+		k.normalize3FastBatch = skScalarKernels::normalize3Batch;
+		k.cullAabb = skScalarKernels::cullAabb;
+		k.cullSphere = skScalarKernels::cullSphere;
+		k.floatToHalfBatch = skScalarKernels::floatToHalfBatch;
+		k.halfToFloatBatch = skScalarKernels::halfToFloatBatch;
+		k.packSnorm16Batch = skScalarKernels::packSnorm16Batch;
+		k.packUnorm16Batch = skScalarKernels::packUnorm16Batch;
+		k.packUnorm8Batch = skScalarKernels::packUnorm8Batch;
+		k.octEncodeBatch = skScalarKernels::octEncodeBatch;
+#ifdef SK_SIMD_X86
+		if (level >= SK_SIMD_SSE41) {
+			k.level = SK_SIMD_SSE41;
+			k.multMat4 = skSse41Kernels::multMat4;
+			k.multMat4Batch = skSse41Kernels::multMat4Batch;
+			k.addMat4 = skSse41Kernels::addMat4;
+			k.multVect4 = skSse41Kernels::multVect4;
+			k.multVect4Batch = skSse41Kernels::multVect4Batch;
+			k.composeAxisAngle = skSse41Kernels::composeAxisAngle;
+			k.composeQuat = skSse41Kernels::composeQuat;
+			k.quatMult = skSse41Kernels::quatMult;
+			k.quatNormalize = skSse41Kernels::quatNormalize;
+			k.quatNlerp = skSse41Kernels::quatNlerp;
+			k.quatSlerp = skSse41Kernels::quatSlerp;
+			k.quatToMat = skSse41Kernels::quatToMat;
+			k.sincosBatch = skSse41Kernels::sincosBatch;
+			k.inverseBatch = skSse41Kernels::inverseBatch;
+			k.affineInverseBatch = skSse41Kernels::affineInverseBatch;
+			k.normalMatrixBatch = skSse41Kernels::normalMatrixBatch;
+			k.normalize3Batch = skSse41Kernels::normalize3Batch;
+			k.normalize3FastBatch = skSse41Kernels::normalize3FastBatch;
+			k.cullAabb = skSse41Kernels::cullAabb;
+			k.cullSphere = skSse41Kernels::cullSphere;
+			k.floatToHalfBatch = skSse41Kernels::floatToHalfBatch;
+			k.halfToFloatBatch = skSse41Kernels::halfToFloatBatch;
+			k.packSnorm16Batch = skSse41Kernels::packSnorm16Batch;
+			k.packUnorm16Batch = skSse41Kernels::packUnorm16Batch;
+			k.packUnorm8Batch = skSse41Kernels::packUnorm8Batch;
+			k.octEncodeBatch = skSse41Kernels::octEncodeBatch;
+		}
+		if (level >= SK_SIMD_AVX2) {
+			k.level = SK_SIMD_AVX2;
+			k.multMat4 = skAvx2Kernels::multMat4;
+			k.multMat4Batch = skAvx2Kernels::multMat4Batch;
+			k.addMat4 = skAvx2Kernels::addMat4;
+			k.multVect4 = skAvx2Kernels::multVect4;
+			k.multVect4Batch = skAvx2Kernels::multVect4Batch;
+			k.composeAxisAngle = skAvx2Kernels::composeAxisAngle;
+			k.composeQuat = skAvx2Kernels::composeQuat;
+			k.quatMult = skAvx2Kernels::quatMult;
+			k.quatNormalize = skAvx2Kernels::quatNormalize;
+			k.quatNlerp = skAvx2Kernels::quatNlerp;
+			k.quatSlerp = skAvx2Kernels::quatSlerp;
+			k.quatToMat = skAvx2Kernels::quatToMat;
+			k.sincosBatch = skAvx2Kernels::sincosBatch;
+			k.inverseBatch = skAvx2Kernels::inverseBatch;
+			k.affineInverseBatch = skAvx2Kernels::affineInverseBatch;
+			k.normalMatrixBatch = skAvx2Kernels::normalMatrixBatch;
+			k.normalize3Batch = skAvx2Kernels::normalize3Batch;
+			k.normalize3FastBatch = skAvx2Kernels::normalize3FastBatch;
+			k.cullAabb = skAvx2Kernels::cullAabb;
+			k.cullSphere = skAvx2Kernels::cullSphere;
+			k.floatToHalfBatch = skAvx2Kernels::floatToHalfBatch;
+			k.halfToFloatBatch = skAvx2Kernels::halfToFloatBatch;
+			k.packSnorm16Batch = skAvx2Kernels::packSnorm16Batch;
+			k.packUnorm16Batch = skAvx2Kernels::packUnorm16Batch;
+			k.packUnorm8Batch = skAvx2Kernels::packUnorm8Batch;
+			k.octEncodeBatch = skAvx2Kernels::octEncodeBatch;
+		}
+#endif
+		return k;
+	}
+	static const skCpuFeatures& cpu() {
+		static const skCpuFeatures features = skCpuFeatures::detect();
+		return features;
+	}
+	static skKernels& active() {
+		static skKernels kernels = forLevel(cpu().bestLevel());
+		return kernels;
+	}
+	// Drop to a lower tier (tests, benchmarks, debugging), never above what the CPU supports
+	static skSimdLevel setLevel(skSimdLevel level) {
+		skSimdLevel best = cpu().bestLevel();
+		active() = forLevel(level < best ? level : best);
+		return active().level;
+	}
+};
+
+#endif // !SKSIMD_H
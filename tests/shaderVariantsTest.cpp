@@ -0,0 +1,82 @@
+// Valor engine by Valores M.
+// ShaderVariants dedup: masks that differ only in bits without a feature must share one
+// program. Needs a GL 4.3 context through EGL (Mesa surfaceless works), skips without one.
+// Build with tests/Makefile, run from tests/
+#include <glad/glad.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "shaderVariants.h"
+
+static int failures = 0;
+
+static bool createContext() {
+	EGLDisplay display = EGL_NO_DISPLAY;
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	if (getPlatformDisplay != nullptr) {
+		display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+	}
+	if (display == EGL_NO_DISPLAY) {
+		display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	}
+	EGLint major, minor;
+	if (!eglInitialize(display, &major, &minor)) {
+		return false;
+	}
+	EGLint configAttribs[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+	EGLConfig config;
+	EGLint configCount = 0;
+	eglChooseConfig(display, configAttribs, &config, 1, &configCount);
+	eglBindAPI(EGL_OPENGL_API);
+	EGLint contextAttribs[] = { EGL_CONTEXT_MAJOR_VERSION, 4, EGL_CONTEXT_MINOR_VERSION, 3, EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT, EGL_NONE };
+	EGLContext context = eglCreateContext(display, configCount ? config : NULL, EGL_NO_CONTEXT, contextAttribs);
+	if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+		return false;
+	}
+	if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress)) {
+		return false;
+	}
+	GLExt::get().load((GLADloadproc)eglGetProcAddress);
+	return true;
+}
+
+static void check(const char* name, bool pass) {
+	printf("%s %s\n", pass ? "PASS" : "FAIL", name);
+	if (!pass) {
+		failures++;
+	}
+}
+
+int main() {
+	if (!createContext()) {
+		printf("SKIP no GL 4.3 context\n");
+		return 0;
+	}
+	// every permutation compiles from source, nothing left behind in tests/
+	ProgramBinaryCache::get().enabled = false;
+
+	std::vector<std::string> features;
+	features.push_back("FEATURE_A");
+	features.push_back("FEATURE_B");
+	ShaderVariants variants("../shaders/vertex.vs", "../shaders/fragment.fs", features);
+	uint32_t unused = 1u << features.size();
+
+	for (uint32_t m = 0; m < unused; m++) {
+		Shader& plain = variants.get(m);
+		Shader& high = variants.get(m | unused);
+		Shader& top = variants.get(m | 0x80000000u);
+		char name[64];
+		snprintf(name, sizeof(name), "mask %u shares its program", m);
+		check(name, &plain == &high && &plain == &top && plain.ID != 0);
+	}
+	check("one program per used mask", variants.compiledCount() == unused);
+	check("every unused-bit request is a hit", variants.hitCount() == unused * 2);
+	variants.release();
+
+	printf("%s\n", failures ? "FAILED" : "OK");
+	return failures ? 1 : 0;
+}
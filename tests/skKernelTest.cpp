@@ -0,0 +1,130 @@
+// Valor engine by Valores M.
+// SIMD kernels vs skScalarKernels on random inputs, every tier the CPU supports. Build with tests/Makefile
+#include "skSimd.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Settings
+// Inputs stay within [-10, 10], so every output is a sum of 4 products of at most 100.
+// FMA contraction and a different summation order move it by a few float ulp of that
+// 400 (ulp 3e-5), so |simd - scalar| <= 2e-4 is the bound
+static const float tolerance = 2e-4f;
+static const size_t batchCounts[] = { 0, 1, 3, 4, 7, 8, 9, 17, 1000 };
+static const int singleRuns = 1000;
+// End of Settings
+
+static int failures = 0;
+
+static const char* tierName(skSimdLevel level) {
+	switch (level) {
+	case SK_SIMD_AVX2: return "avx2";
+	case SK_SIMD_SSE41: return "sse41";
+	default: return "scalar";
+	}
+}
+
+static float rnd() {
+	return ((float)rand() / (float)RAND_MAX * 2.0f - 1.0f) * 10.0f;
+}
+
+static std::vector<float> randomFloats(size_t n) {
+	std::vector<float> v(n);
+	for (size_t i = 0; i < n; i++) {
+		v[i] = rnd();
+	}
+	return v;
+}
+
+static float worstError(const float* got, const float* want, size_t n) {
+	float worst = 0.0f;
+	for (size_t i = 0; i < n; i++) {
+		float err = std::fabs(got[i] - want[i]);
+		if (!(err <= worst)) {
+			worst = err;
+		}
+	}
+	return worst;
+}
+
+static void check(skSimdLevel level, const char* kernel, float worst) {
+	bool pass = worst <= tolerance;
+	printf("%s %-6s %-15s max abs err %g\n", pass ? "PASS" : "FAIL", tierName(level), kernel, worst);
+	if (!pass) {
+		failures++;
+	}
+}
+
+static void testLevel(skSimdLevel level) {
+	skKernels k = skKernels::forLevel(level);
+	float worst = 0.0f;
+	for (int r = 0; r < singleRuns; r++) {
+		std::vector<float> a = randomFloats(16), b = randomFloats(16), got(16), want(16);
+		k.multMat4(a.data(), b.data(), got.data());
+		skScalarKernels::multMat4(a.data(), b.data(), want.data());
+		worst = std::fmax(worst, worstError(got.data(), want.data(), 16));
+		// out may alias an input
+		k.multMat4(a.data(), b.data(), a.data());
+		worst = std::fmax(worst, worstError(a.data(), want.data(), 16));
+	}
+	check(level, "multMat4", worst);
+
+	worst = 0.0f;
+	for (int r = 0; r < singleRuns; r++) {
+		std::vector<float> a = randomFloats(16), b = randomFloats(16), got(16), want(16);
+		k.addMat4(a.data(), b.data(), got.data());
+		skScalarKernels::addMat4(a.data(), b.data(), want.data());
+		worst = std::fmax(worst, worstError(got.data(), want.data(), 16));
+	}
+	check(level, "addMat4", worst);
+
+	worst = 0.0f;
+	for (int r = 0; r < singleRuns; r++) {
+		std::vector<float> m = randomFloats(16), v = randomFloats(4), got(4), want(4);
+		k.multVect4(m.data(), v.data(), got.data());
+		skScalarKernels::multVect4(m.data(), v.data(), want.data());
+		worst = std::fmax(worst, worstError(got.data(), want.data(), 4));
+	}
+	check(level, "multVect4", worst);
+
+	// odd counts exercise the scalar tails after the vector loops
+	worst = 0.0f;
+	for (size_t c = 0; c < sizeof(batchCounts) / sizeof(batchCounts[0]); c++) {
+		size_t n = batchCounts[c];
+		std::vector<float> a = randomFloats(n * 16), b = randomFloats(n * 16), got(n * 16 + 1), want(n * 16 + 1);
+		got[n * 16] = want[n * 16] = 42.0f;
+		k.multMat4Batch(a.data(), b.data(), got.data(), n);
+		skScalarKernels::multMat4Batch(a.data(), b.data(), want.data(), n);
+		// the sentinel past the end must be untouched
+		worst = std::fmax(worst, worstError(got.data(), want.data(), n * 16 + 1));
+	}
+	check(level, "multMat4Batch", worst);
+
+	worst = 0.0f;
+	for (size_t c = 0; c < sizeof(batchCounts) / sizeof(batchCounts[0]); c++) {
+		size_t n = batchCounts[c];
+		std::vector<float> m = randomFloats(16), v = randomFloats(n * 4), got(n * 4 + 1), want(n * 4 + 1);
+		got[n * 4] = want[n * 4] = 42.0f;
+		k.multVect4Batch(m.data(), v.data(), got.data(), n);
+		skScalarKernels::multVect4Batch(m.data(), v.data(), want.data(), n);
+		worst = std::fmax(worst, worstError(got.data(), want.data(), n * 4 + 1));
+	}
+	check(level, "multVect4Batch", worst);
+}
+
+int main() {
+	srand(1234);
+	skSimdLevel best = skKernels::cpu().bestLevel();
+	printf("cpu best tier %s, tolerance %g\n", tierName(best), tolerance);
+	for (int level = SK_SIMD_SSE41; level <= SK_SIMD_AVX2; level++) {
+		if (level > best) {
+			printf("SKIP %s, not supported by this CPU\n", tierName((skSimdLevel)level));
+			continue;
+		}
+		testLevel((skSimdLevel)level);
+	}
+	printf("%s\n", failures ? "FAILED" : "OK");
+	return failures ? 1 : 0;
+}
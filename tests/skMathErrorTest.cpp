@@ -0,0 +1,195 @@
+// Valor engine by Valores M.
+// skMathFn error sweep against double precision references, fails when a documented bound is
+// exceeded. Batch entry points run at every tier the CPU supports. Build with tests/Makefile
+#include <glad/glad.h>
+#include "skMath.h"
+
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Settings
+// Bounds as documented on skMathFn in skMath.h
+static const double rsqrtMaxRel = 5e-7;
+static const double sincosMaxAbs = 1e-7;
+static const double sincosMaxUlp = 2.0;
+// "away from the zeros": the ulp bound applies where |reference| is at least this
+static const double sincosUlpFloor = 1e-3;
+static const double sincosRange = 8192.0;
+static const double atan2MaxAbs = 1.2e-5;
+static const double normalizeMaxRel = 5e-7;
+static const double normalizePreciseMaxAbs = 3e-7;
+static const size_t sampleCount = 1 << 21;
+// End of Settings
+
+static int failures = 0;
+
+static const char* tierName(skSimdLevel level) {
+	switch (level) {
+	case SK_SIMD_AVX2: return "avx2";
+	case SK_SIMD_SSE41: return "sse41";
+	default: return "scalar";
+	}
+}
+
+static double uniform(double lo, double hi) {
+	return lo + (hi - lo) * ((double)rand() / (double)RAND_MAX);
+}
+
+// Distance in units of the float ulp at the reference
+static double ulps(float got, double want) {
+	float w = (float)std::fabs(want);
+	double ulp = (double)std::nextafter(w, FLT_MAX) - (double)w;
+	return std::fabs((double)got - want) / ulp;
+}
+
+struct ErrorStats {
+	double maxUlp = 0.0;
+	double maxAbs = 0.0;
+	double maxRel = 0.0;
+
+	void add(float got, double want, bool countUlp = true) {
+		double abs = std::fabs((double)got - want);
+		// NaN compares false, make it count as failing
+		if (!(abs <= maxAbs)) {
+			maxAbs = abs != abs ? HUGE_VAL : abs;
+		}
+		if (want != 0.0 && !(abs / std::fabs(want) <= maxRel)) {
+			maxRel = abs != abs ? HUGE_VAL : abs / std::fabs(want);
+		}
+		if (countUlp) {
+			double u = ulps(got, want);
+			if (!(u <= maxUlp)) {
+				maxUlp = u != u ? HUGE_VAL : u;
+			}
+		}
+	}
+};
+
+static void check(const char* tier, const char* name, const ErrorStats& e, const char* bound, bool pass) {
+	printf("%s %-6s %-22s max ulp %-9.3g max abs %-10.3g max rel %-10.3g bound %s\n", pass ? "PASS" : "FAIL", tier, name, e.maxUlp, e.maxAbs, e.maxRel, bound);
+	if (!pass) {
+		failures++;
+	}
+}
+
+static void testRsqrt() {
+	ErrorStats e;
+	for (size_t i = 0; i < sampleCount; i++) {
+		// log-uniform over the normal float range
+		float x = (float)std::pow(2.0, uniform(-126.0, 127.0));
+		e.add(skMathFn<SK_FAST>::rsqrt(x), 1.0 / std::sqrt((double)x));
+	}
+	check("scalar", "rsqrt", e, "rel 5e-7", e.maxRel <= rsqrtMaxRel);
+}
+
+static void sincosSamples(std::vector<float>& angle) {
+	angle.resize(sampleCount);
+	for (size_t i = 0; i < sampleCount; i++) {
+		// half the samples near the origin, where most angles live
+		angle[i] = (float)(i & 1 ? uniform(-sincosRange, sincosRange) : uniform(-8.0, 8.0));
+	}
+}
+
+static void checkSincos(const char* tier, const char* name, const std::vector<float>& angle, const std::vector<float>& s, const std::vector<float>& c) {
+	ErrorStats e;
+	for (size_t i = 0; i < angle.size(); i++) {
+		double ws = std::sin((double)angle[i]), wc = std::cos((double)angle[i]);
+		e.add(s[i], ws, std::fabs(ws) >= sincosUlpFloor);
+		e.add(c[i], wc, std::fabs(wc) >= sincosUlpFloor);
+	}
+	check(tier, name, e, "abs 1e-7, 2 ulp", e.maxAbs <= sincosMaxAbs && e.maxUlp <= sincosMaxUlp);
+}
+
+static void testSincos() {
+	std::vector<float> angle, s(sampleCount), c(sampleCount);
+	sincosSamples(angle);
+	for (size_t i = 0; i < sampleCount; i++) {
+		skMathFn<SK_FAST>::sincos(angle[i], &s[i], &c[i]);
+	}
+	checkSincos("scalar", "sincos", angle, s, c);
+}
+
+static void testAtan2() {
+	ErrorStats e;
+	for (size_t i = 0; i < sampleCount; i++) {
+		double scale = std::pow(10.0, uniform(-6.0, 6.0));
+		float y = (float)(uniform(-1.0, 1.0) * scale), x = (float)(uniform(-1.0, 1.0) * scale);
+		// the axes and the diagonal take their own branches
+		if (i % 16 == 0) {
+			x = 0.0f;
+		}
+		else if (i % 16 == 1) {
+			y = 0.0f;
+		}
+		else if (i % 16 == 2) {
+			y = x;
+		}
+		if (x == 0.0f && y == 0.0f) {
+			continue;
+		}
+		double want = std::atan2((double)y, (double)x);
+		e.add(skMathFn<SK_FAST>::atan2(y, x), want, std::fabs(want) >= sincosUlpFloor);
+	}
+	check("scalar", "atan2", e, "abs 1.2e-5", e.maxAbs <= atan2MaxAbs);
+}
+
+static void testNormalize(skSimdLevel level, bool fast) {
+	std::vector<float> x(sampleCount), y(sampleCount), z(sampleCount);
+	std::vector<double> wx(sampleCount), wy(sampleCount), wz(sampleCount);
+	for (size_t i = 0; i < sampleCount; i++) {
+		double scale = std::pow(10.0, uniform(-10.0, 10.0));
+		x[i] = (float)(uniform(-1.0, 1.0) * scale);
+		y[i] = (float)(uniform(-1.0, 1.0) * scale);
+		z[i] = (float)(uniform(-1.0, 1.0) * scale);
+		double inv = 1.0 / std::sqrt((double)x[i] * x[i] + (double)y[i] * y[i] + (double)z[i] * z[i]);
+		wx[i] = x[i] * inv;
+		wy[i] = y[i] * inv;
+		wz[i] = z[i] * inv;
+	}
+	if (fast) {
+		skMathFn<SK_FAST>::normalizeBatch(x.data(), y.data(), z.data(), sampleCount);
+	}
+	else {
+		skMathFn<SK_PRECISE>::normalizeBatch(x.data(), y.data(), z.data(), sampleCount);
+	}
+	// error relative to the unit length, components near zero would blow up a per-component ratio
+	ErrorStats e;
+	for (size_t i = 0; i < sampleCount; i++) {
+		e.add(x[i], wx[i], false);
+		e.add(y[i], wy[i], false);
+		e.add(z[i], wz[i], false);
+	}
+	e.maxRel = e.maxAbs;
+	if (fast) {
+		check(tierName(level), "normalizeBatch fast", e, "rel 5e-7", e.maxAbs <= normalizeMaxRel);
+	}
+	else {
+		check(tierName(level), "normalizeBatch precise", e, "abs 3e-7", e.maxAbs <= normalizePreciseMaxAbs);
+	}
+}
+
+int main() {
+	srand(4321);
+	testRsqrt();
+	testSincos();
+	testAtan2();
+	skSimdLevel best = skKernels::cpu().bestLevel();
+	for (int level = SK_SIMD_SCALAR; level <= SK_SIMD_AVX2; level++) {
+		if (level > best) {
+			printf("SKIP %s, not supported by this CPU\n", tierName((skSimdLevel)level));
+			continue;
+		}
+		skKernels::setLevel((skSimdLevel)level);
+		std::vector<float> angle, s(sampleCount), c(sampleCount);
+		sincosSamples(angle);
+		skMathFn<SK_FAST>::sincosBatch(angle.data(), s.data(), c.data(), sampleCount);
+		checkSincos(tierName((skSimdLevel)level), "sincosBatch", angle, s, c);
+		testNormalize((skSimdLevel)level, true);
+		testNormalize((skSimdLevel)level, false);
+	}
+	printf("%s\n", failures ? "FAILED" : "OK");
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,122 @@
+// Valor engine by Valores M.
+// std140 uniform blocks shared by every program at fixed binding points
+#ifndef UNIFORMBUFFERS_H
+#define UNIFORMBUFFERS_H
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <vector>
+
+#include "skHash.h"
+#include "glState.h"
+#include "frameRing.h"
+
+// Binding points are global GL state, every program sees the same buffer at the same index
+enum UniformBinding {
+	SK_UBO_FRAME = 0,
+	SK_UBO_VIEW = 1,
+	// range of MaterialLibrary's buffer, moved per material (material.h)
+	SK_UBO_MATERIAL = 2
+};
+
+// Mirrors of the GLSL blocks, field order and padding follow std140 (vec3 rounds up to vec4)
+//   layout (std140) uniform FrameData { float time; float deltaTime; vec2 resolution; };
+struct alignas(16) FrameData {
+	float time = 0.0f;
+	float deltaTime = 0.0f;
+	float resolution[2] = { 0.0f, 0.0f };
+};
+//   layout (std140) uniform ViewData { mat4 view; mat4 projection; mat4 viewProj; vec4 camPos; };
+struct alignas(16) ViewData {
+	float view[16];
+	float projection[16];
+	float viewProj[16];
+	float camPos[4];
+};
+static_assert(sizeof(FrameData) == 16, "FrameData must match the std140 block size");
+static_assert(offsetof(FrameData, resolution) == 8, "std140 puts vec2 on an 8 byte boundary");
+static_assert(sizeof(ViewData) == 208, "ViewData must match the std140 block size");
+static_assert(offsetof(ViewData, camPos) == 192, "std140 puts vec4 on a 16 byte boundary");
+
+// Block name to binding point. Shader looks every active block up here after linking and
+// calls glUniformBlockBinding, so GLSL only has to use the agreed block name
+class UniformBlockRegistry {
+public:
+	static UniformBlockRegistry& get() {
+		static UniformBlockRegistry registry;
+		return registry;
+	}
+	void add(const char* blockName, GLuint binding) {
+		uint32_t hash = skHash32(blockName);
+		for (size_t i = 0; i < entries.size(); i++) {
+			if (entries[i].hash == hash) {
+				entries[i].binding = binding;
+				return;
+			}
+		}
+		Entry e;
+		e.hash = hash;
+		e.binding = binding;
+		entries.push_back(e);
+	}
+	// -1 when the block is not registered
+	int bindingFor(uint32_t blockHash) const {
+		for (size_t i = 0; i < entries.size(); i++) {
+			if (entries[i].hash == blockHash) {
+				return (int)entries[i].binding;
+			}
+		}
+		return -1;
+	}
+private:
+	struct Entry {
+		uint32_t hash;
+		GLuint binding;
+	};
+	std::vector<Entry> entries;
+
+	UniformBlockRegistry() {
+		add("FrameData", SK_UBO_FRAME);
+		add("ViewData", SK_UBO_VIEW);
+		add("MaterialData", SK_UBO_MATERIAL);
+	}
+};
+
+// One buffer bound to one binding point, rewritten whole once per frame
+template<class T>
+class UniformBlock {
+public:
+	GLuint buffer = 0;
+	GLuint binding = 0;
+
+	void create(GLuint bindingPoint) {
+		binding = bindingPoint;
+		glGenBuffers(1, &buffer);
+		GLState::get().bindBuffer(GL_UNIFORM_BUFFER, buffer);
+		glBufferData(GL_UNIFORM_BUFFER, sizeof(T), NULL, GL_DYNAMIC_DRAW);
+		GLState::get().bindBufferBase(GL_UNIFORM_BUFFER, binding, buffer);
+	}
+	void upload(const T& data) const {
+		GLState::get().bindBuffer(GL_UNIFORM_BUFFER, buffer);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(T), &data);
+	}
+	// Per-frame path: the data goes into this frame's ring region and the binding point is
+	// moved to that slice. Falls back to the block's own buffer when the ring is full
+	void upload(const T& data, FrameRing& ring) const {
+		RingAllocation slice = ring.write(&data, sizeof(T), FrameRing::uniformAlignment());
+		if (!slice.valid()) {
+			upload(data);
+			GLState::get().bindBufferBase(GL_UNIFORM_BUFFER, binding, buffer);
+			return;
+		}
+		GLState::get().bindBufferRange(GL_UNIFORM_BUFFER, binding, ring.buffer, slice.offset, slice.size);
+	}
+	void destroy() {
+		GLState::get().forgetBuffer(buffer);
+		glDeleteBuffers(1, &buffer);
+		buffer = 0;
+	}
+};
+
+#endif // !UNIFORMBUFFERS_H
@@ -9,9 +9,17 @@
 #include <sstream>
 
 
-//#include "skMath.h"
+#include "skMath.h"
 #include "stb_image.h"
 #include "shader.h"
+#include "shaderWatcher.h"
+#include "uniformBuffers.h"
+#include "glState.h"
+#include "material.h"
+#include "drawData.h"
+#include "renderCommands.h"
+#include "meshBuilder.h"
+#include "frameRing.h"
 
 #include <glm.hpp>
 #include <gtc/matrix_transform.hpp>
@@ -134,23 +142,34 @@ int main()
 		std::cout << "Failed to initialize GLAD" << std::endl;
 		return -1;
 	};
+	GLExt::get().load((GLADloadproc)glfwGetProcAddress);
 	// end glad block
 	// 
-	glEnable(GL_DEPTH_TEST);
+	// all binds and toggles go through the state cache, repeats never reach the driver
+	GLState& glState = GLState::get();
+	glState.setDepthTest(true);
 
 	/////////////////////////////////////////////////////////////////////////////////////////////
 	Shader shaderProg("shaders/vertex.vs", "shaders/fragment.fs");
+	ProgramBinaryCache::get().report();
+	// edit the shaders while running, the program is relinked and swapped in place
+	ShaderWatcher shaderWatcher;
+	shaderWatcher.watch(shaderProg, "shaders/vertex.vs", "shaders/fragment.fs");
 	/////////////////////////////////////////////////////////////////////////////////////////////
 	// Buffer VBO AND Vertex Array Object ~ supplies data from array buffer
 	// Setup Vertex Buffer Objects (VBO)
-	unsigned int VAO, VBO;
+	unsigned int VAO, VBO, EBO;
 	glGenVertexArrays(1, &VAO);
 	glGenBuffers(1, &VBO);
-	glBindVertexArray(VAO);
-
-	
-	glBindBuffer(GL_ARRAY_BUFFER, VBO); // bind the current array buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+	glGenBuffers(1, &EBO);
+	glState.bindVertexArray(VAO);
+
+	// weld the 36 listed cube vertices into unique ones plus an index buffer, drawn indexed
+	// so shared corners come out of the post-transform cache
+	MeshBuilder cubeMesh;
+	cubeMesh.addTriangles(vertices, sizeof(vertices) / sizeof(float) / 5);
+	cubeMesh.upload(VBO, EBO); // VAO is bound, the element buffer stays attached to it
+	cubeMesh.report();
 	// Stream: set once, used a few times. Static: set once, used many times. Dynamic: changed a lot and used many times
 	// Set vertex attrib pointers
 	/////////////////////////////////////////////////////////////////////////////////////////////
@@ -166,7 +185,7 @@ int main()
 	glUniform1i(glGetUniformLocation(shaderProg.ID, "texture1"), 0);
 	shaderProg.setInt("texture2", 1);
 
-	glBindVertexArray(0);
+	glState.bindVertexArray(0);
 	// End VBO Section
 	
 
@@ -174,7 +193,7 @@ int main()
 	// texture 1
 	// ---------
 	glGenTextures(1, &texture1);
-	glBindTexture(GL_TEXTURE_2D, texture1);
+	glState.bindTexture(0, GL_TEXTURE_2D, texture1);
 	// set the texture wrapping parameters
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -198,7 +217,7 @@ int main()
 	// texture 2
 	// ---------
 	glGenTextures(1, &texture2);
-	glBindTexture(GL_TEXTURE_2D, texture2);
+	glState.bindTexture(0, GL_TEXTURE_2D, texture2);
 	// set the texture wrapping parameters
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -225,16 +244,79 @@ int main()
 	shaderProg.setInt("texture1", 0);
 	shaderProg.setInt("texture2", 1);
 
+	// Cube transforms never change, compose all model matrices in one batch up front
+	const unsigned int cubeCount = sizeof(cubePositions) / sizeof(cubePositions[0]);
+	float cubeX[cubeCount], cubeY[cubeCount], cubeZ[cubeCount];
+	float axisX[cubeCount], axisY[cubeCount], axisZ[cubeCount], cubeAngle[cubeCount];
+	for (unsigned int i = 0; i < cubeCount; i++) {
+		cubeX[i] = cubePositions[i].x;
+		cubeY[i] = cubePositions[i].y;
+		cubeZ[i] = cubePositions[i].z;
+		axisX[i] = 1.0f;
+		axisY[i] = 0.3f;
+		axisZ[i] = 0.5f;
+		cubeAngle[i] = Mat4x4<float>::toRad(20.0f * i);
+	}
+	skTransformSoA cubeSoA;
+	cubeSoA.posX = cubeX;
+	cubeSoA.posY = cubeY;
+	cubeSoA.posZ = cubeZ;
+	cubeSoA.axisX = axisX;
+	cubeSoA.axisY = axisY;
+	cubeSoA.axisZ = axisZ;
+	cubeSoA.angle = cubeAngle;
+	Mat4x4<float> cubeModels[cubeCount];
+	TransformBatch::composeAxisAngle(cubeSoA, cubeModels[0].data(), cubeCount);
+
+	// frame and camera data go up once per frame, every program reads the same buffers
+	UniformBlock<FrameData> frameBlock;
+	UniformBlock<ViewData> viewBlock;
+	frameBlock.create(SK_UBO_FRAME);
+	viewBlock.create(SK_UBO_VIEW);
+	// everything rewritten each frame is suballocated from here, three frames in flight
+	FrameRing frameRing;
+	if (!frameRing.create(256 * 1024))
+	{
+		std::cout << "Failed to create frame ring, per-frame data uses its own buffers" << std::endl;
+	}
+	FrameData frameData;
+	ViewData viewData;
+
+	// material parameters live in one buffer, picking a material just moves the bound range
+	MaterialLibrary materials;
+	int materialLayout = materials.addLayout(shaderProg);
+	int crateMaterial = materials.create(materialLayout);
+	int faceMaterial = materials.create(materialLayout);
+	materials.set(crateMaterial, SK_HASH("tint"), glm::vec4(1.0f));
+	materials.set(crateMaterial, SK_HASH("mixAmount"), 0.2f);
+	materials.set(faceMaterial, SK_HASH("tint"), glm::vec4(1.0f, 0.85f, 0.6f, 1.0f));
+	materials.set(faceMaterial, SK_HASH("mixAmount"), 0.6f);
+	materials.upload();
+	materials.report();
+
+	// per-draw model matrix and material index, the vertex shader finds its record through
+	// the base instance so no uniform is touched between draws
+	DrawDataBuffer drawData;
+	drawData.create(cubeCount);
+	drawData.attach(VAO);
+	DrawDataBuffer::report();
+	// every draw goes through a sort key: state changes grouped, opaque front to back,
+	// identical neighbours drawn as one instanced call
+	RenderCommandStream commands;
+
 	/////////////////////////////////////////////////////////////////////////////////////////////
 	// Start Game Loop
 	while (!glfwWindowShouldClose(gameWindow1))
 	{
+		glState.beginFrame();
+		frameRing.beginFrame();
 		float currentFrame = static_cast<float>(glfwGetTime());
 		deltaTime = currentFrame - lastFrame;
 		lastFrame = currentFrame;
 
 		// Input
 		processInput(gameWindow1);
+		shaderWatcher.poll();
 		// end of section
 		
 		// render section
@@ -243,34 +325,46 @@ int main()
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 
-		// Enable textures
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, texture1);
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, texture2);
-
 		// draw a triangle
 		shaderProg.use();
 
-		glm::mat4 projection = glm::perspective(glm::radians(fov), (float)windowWidth / (float)windowHeight, 0.1f, 100.0f);
-		shaderProg.setMat4("projection", projection);
+		frameData.time = currentFrame;
+		frameData.deltaTime = deltaTime;
+		frameData.resolution[0] = (float)windowWidth;
+		frameData.resolution[1] = (float)windowHeight;
+		frameBlock.upload(frameData, frameRing);
 
+		glm::mat4 projection = glm::perspective(glm::radians(fov), (float)windowWidth / (float)windowHeight, 0.1f, 100.0f);
 		// camera/view transformation
 		glm::mat4 view = glm::lookAt(cPos, cPos + cFront, cUp);
-		shaderProg.setMat4("view", view);
-
-		glBindVertexArray(VAO);
-		for (unsigned int i = 0; i < 10; i++)
+		glm::mat4 viewProj = projection * view;
+		memcpy(viewData.view, &view[0][0], sizeof(viewData.view));
+		memcpy(viewData.projection, &projection[0][0], sizeof(viewData.projection));
+		memcpy(viewData.viewProj, &viewProj[0][0], sizeof(viewData.viewProj));
+		viewData.camPos[0] = cPos.x;
+		viewData.camPos[1] = cPos.y;
+		viewData.camPos[2] = cPos.z;
+		viewData.camPos[3] = 1.0f;
+		viewBlock.upload(viewData, frameRing);
+
+		commands.setDepthRange(0.1f, 100.0f);
+		for (unsigned int i = 0; i < cubeCount; i++)
 		{
-			// calculate the model matrix for each object and pass it to shader before drawing
-			glm::mat4 model = glm::mat4(1.0f); // make sure to initialize matrix to identity matrix first
-			model = glm::translate(model, cubePositions[i]);
-			float angle = 20.0f * i;
-			model = glm::rotate(model, glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
-			shaderProg.setMat4("model", model);
-
-			glDrawArrays(GL_TRIANGLES, 0, 36);
+			RenderCommand cube;
+			cube.program = shaderProg.ID;
+			cube.vertexArray = VAO;
+			cube.count = cubeMesh.indexCount();
+			cube.indexType = cubeMesh.indexType();
+			cube.material = i % 3 == 0 ? faceMaterial : crateMaterial;
+			cube.textures[0] = texture1;
+			cube.textures[1] = texture2;
+			// model matrices were composed before the loop
+			cube.model = cubeModels[i].data();
+			float viewDepth = -(view * glm::vec4(cubePositions[i], 1.0f)).z;
+			commands.submit(cube, viewDepth);
 		}
+		commands.flush(drawData, &materials, &frameRing);
+		frameRing.endFrame();
 		// OpenGL function to draw traingle
 		// end of section
 		
@@ -279,9 +373,18 @@ int main()
 		glfwPollEvents();
 		// end of section
 	}
+	glState.report(glState.frame());
+	commands.report(commands.frame());
+	frameRing.report();
 	// Clean up remaining loose ends
 	glDeleteVertexArrays(1, &VAO);
 	glDeleteBuffers(1, &VBO);
+	glDeleteBuffers(1, &EBO);
+	frameBlock.destroy();
+	viewBlock.destroy();
+	materials.destroy();
+	frameRing.destroy();
+	drawData.destroy();
 
 	glfwTerminate();
 	return 0;
@@ -331,10 +434,15 @@ void mouse_callback(GLFWwindow* window, double xposIn, double yposIn)
 	if (pitch < -89.0f)
 		pitch = -89.0f;
 
+	// only pitch is clamped, yaw grows with every turn. SK_FAST sincos does its own range
+	// reduction, so an unbounded yaw stays accurate and the fast tier is plenty
+	float sinYaw, cosYaw, sinPitch, cosPitch;
+	skMathFn<SK_FAST>::sincos(Mat4x4<float>::toRad(yaw), &sinYaw, &cosYaw);
+	skMathFn<SK_FAST>::sincos(Mat4x4<float>::toRad(pitch), &sinPitch, &cosPitch);
 	glm::vec3 front;
-	front.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
-	front.y = sin(glm::radians(pitch));
-	front.z = sin(glm::radians(yaw)) * cos(glm::radians(pitch));
+	front.x = cosYaw * cosPitch;
+	front.y = sinPitch;
+	front.z = sinYaw * cosPitch;
 	cFront = glm::normalize(front);
 }
 